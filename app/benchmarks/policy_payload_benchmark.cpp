@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "cose.h"
+#include "policy_engine.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+
+using namespace scitt;
+
+namespace
+{
+  // Compare running a policy on payloads of increasing sizes, when the
+  // payload is passed without a copy, and when it is first copied as it was
+  // before.
+  TEST(PolicyPayloadBenchmark, PayloadSize)
+  {
+    const std::string script = R"(
+      export function apply(phdr, uhdr, payload) {
+        return new Uint8Array(payload)[0] === 123 || "Invalid payload";
+      })";
+    cose::ProtectedHeader phdr;
+    phdr.cwt_claims.iss = "did:example:issuer";
+    const cose::UnprotectedHeader uhdr;
+
+    constexpr size_t ITERATIONS = 100;
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    for (size_t size : {1024, 1024 * 1024, 8 * 1024 * 1024})
+    {
+      std::vector<uint8_t> payload(size, 'x');
+      payload.front() = '{';
+
+      auto start = Clock::now();
+      for (size_t i = 0; i < ITERATIONS; i++)
+      {
+        ASSERT_EQ(
+          js::apply_js_policy(
+            script, "test", phdr, uhdr, payload, std::nullopt),
+          std::nullopt);
+      }
+      auto direct_time = Clock::now() - start;
+
+      start = Clock::now();
+      for (size_t i = 0; i < ITERATIONS; i++)
+      {
+        std::vector<uint8_t> copy(payload.begin(), payload.end());
+        ASSERT_EQ(
+          js::apply_js_policy(script, "test", phdr, uhdr, copy, std::nullopt),
+          std::nullopt);
+      }
+      auto copy_time = Clock::now() - start;
+
+      std::cout << size << " byte payload: "
+                << duration_cast<microseconds>(direct_time).count() / ITERATIONS
+                << "us without a copy, "
+                << duration_cast<microseconds>(copy_time).count() / ITERATIONS
+                << "us with a copy, per evaluation" << std::endl;
+    }
+  }
+}
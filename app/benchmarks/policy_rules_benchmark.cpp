@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "policy_rules.h"
+
+#include "cose.h"
+#include "kv_types.h"
+#include "policy_engine.h"
+#include "verifier.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+
+using namespace scitt;
+
+namespace
+{
+  PolicyRule rule(
+    const std::string& field, const std::string& op, nlohmann::json value)
+  {
+    return PolicyRule{
+      .field = field, .op = op, .value = std::move(value), .reason = {}};
+  }
+
+  // Compare the rules to an equivalent policy script, on an attested signed
+  // statement which exercises both header and attestation fields.
+  TEST(PolicyRulesBenchmark, AgainstScript)
+  {
+    std::string filepath = "test_payloads/css-attested-cosesign1-20250925.cose";
+    std::ifstream file(filepath, std::ios::binary);
+    ASSERT_TRUE(file.is_open());
+    std::vector<uint8_t> signed_statement(std::filesystem::file_size(filepath));
+    file.read(
+      reinterpret_cast<char*>(signed_statement.data()),
+      static_cast<std::streamsize>(signed_statement.size()));
+
+    auto verifier = std::make_unique<verifier::Verifier>();
+    ccf::kv::ReadOnlyTx* tx_ptr = nullptr;
+    timespec time = {0, 0};
+    Configuration configuration;
+    cose::ProtectedHeader phdr;
+    cose::UnprotectedHeader uhdr;
+    std::span<uint8_t> payload;
+    std::optional<verifier::VerifiedSevSnpAttestationDetails> details;
+    std::tie(phdr, uhdr, payload, details) = verifier->verify_signed_statement(
+      signed_statement, *tx_ptr, time, configuration);
+
+    const std::string script = R"(
+      export function apply(phdr, uhdr, payload, details) {
+        if (details.product_name !== "Milan") { return "Invalid product"; }
+        if (details.reported_tcb.hexstring !== "db18000000000004") {
+          return "Invalid reported TCB";
+        }
+        if (details.uvm_endorsements.feed !== "ContainerPlat-AMD-UVM") {
+          return "Invalid uvm_endorsements feed";
+        }
+        if (details.uvm_endorsements.svn < "101") {
+          return "Invalid uvm_endorsements svn";
+        }
+        if (details.host_data !== "73973b78d70cc68353426de188db5dfc" +
+                                  "57e5b766e399935fb73a61127ea26d20") {
+          return "Invalid host data";
+        }
+        if (!phdr.cwt.iss.startsWith("did:attestedsvc:msft-css-dev:")) {
+          return "Invalid issuer";
+        }
+        return true;
+      })";
+    const auto rules = CompiledPolicyRules::compile({
+      rule("details.product_name", "==", "Milan"),
+      rule("details.reported_tcb.hexstring", "==", "db18000000000004"),
+      rule("details.uvm_endorsements.feed", "==", "ContainerPlat-AMD-UVM"),
+      rule("details.uvm_endorsements.svn", ">=", "101"),
+      rule(
+        "details.host_data",
+        "==",
+        "73973b78d70cc68353426de188db5dfc57e5b766e399935fb73a61127ea26d20"),
+      rule("phdr.cwt.iss", "startsWith", "did:attestedsvc:msft-css-dev:"),
+    });
+
+    ASSERT_EQ(
+      js::apply_js_policy(script, "test", phdr, uhdr, payload, details),
+      std::nullopt);
+    ASSERT_EQ(rules.evaluate(phdr, details), std::nullopt);
+
+    constexpr size_t ITERATIONS = 100;
+    using Clock = std::chrono::steady_clock;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < ITERATIONS; i++)
+    {
+      js::apply_js_policy(script, "test", phdr, uhdr, payload, details);
+    }
+    auto script_time = Clock::now() - start;
+
+    start = Clock::now();
+    for (size_t i = 0; i < ITERATIONS; i++)
+    {
+      rules.evaluate(phdr, details);
+    }
+    auto rules_time = Clock::now() - start;
+
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+    std::cout << "Policy script: "
+              << duration_cast<nanoseconds>(script_time).count() / ITERATIONS
+              << "ns, policy rules: "
+              << duration_cast<nanoseconds>(rules_time).count() / ITERATIONS
+              << "ns per evaluation" << std::endl;
+  }
+}
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "indexing/seqno_ring.h"
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <map>
+
+using namespace scitt::indexing;
+
+namespace
+{
+  struct State
+  {
+    int64_t created_at = 0;
+    uint64_t view = 0;
+  };
+
+  /**
+   * Compare against the std::map the operations strategy used to keep its
+   * state in, on a sliding window of operations: every new operation is
+   * looked up a few times, and the oldest one is purged.
+   */
+  template <typename Insert, typename Lookup, typename Purge>
+  std::chrono::nanoseconds run_sliding_window(
+    Insert&& insert, Lookup&& lookup, Purge&& purge)
+  {
+    static constexpr ccf::SeqNo TOTAL = 1'000'000;
+    static constexpr ccf::SeqNo WINDOW = 100'000;
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t found = 0;
+    for (ccf::SeqNo seqno = 1; seqno <= TOTAL; seqno++)
+    {
+      insert(seqno);
+      if (seqno > WINDOW)
+      {
+        purge();
+      }
+      found += lookup(seqno);
+      found += lookup(seqno - WINDOW / 2);
+      found += lookup(seqno + 1);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    EXPECT_GT(found, TOTAL);
+    return end - start;
+  }
+
+  TEST(SeqNoRingBenchmark, AgainstMap)
+  {
+    std::map<ccf::SeqNo, State> map;
+    auto map_time = run_sliding_window(
+      [&](ccf::SeqNo seqno) { map.emplace(seqno, State{}); },
+      [&](ccf::SeqNo seqno) { return map.find(seqno) != map.end(); },
+      [&]() { map.erase(map.begin()); });
+
+    SeqNoRing<State> ring;
+    auto ring_time = run_sliding_window(
+      [&](ccf::SeqNo seqno) { ring.push_back(seqno, State{}); },
+      [&](ccf::SeqNo seqno) { return ring.find(seqno) != nullptr; },
+      [&]() { ring.pop_front(); });
+
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    std::cout << "std::map: " << duration_cast<milliseconds>(map_time).count()
+              << "ms, SeqNoRing: "
+              << duration_cast<milliseconds>(ring_time).count() << "ms, "
+              << ring.size_bytes() / ring.size() << " bytes per entry"
+              << std::endl;
+  }
+}
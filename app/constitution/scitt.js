@@ -19,6 +19,55 @@ actions.set("set_scitt_configuration",
           }
         }
         checkType(args.configuration.policy.policyScript, "string?", "configuration.policy.policyScript");
+        checkType(args.configuration.policy.policyVerdictCacheSize, "integer?", "configuration.policy.policyVerdictCacheSize");
+        if (args.configuration.policy.policyVerdictCacheSize !== undefined) {
+          checkBounds(args.configuration.policy.policyVerdictCacheSize, 0, 100000, "configuration.policy.policyVerdictCacheSize");
+        }
+        const checkPolicyRules = (rules, field) => {
+          checkType(rules, "array?", field);
+          if (rules) {
+            const ops = ["==", "!=", "<", "<=", ">", ">=", "startsWith", "in"];
+            for (const [i, rule] of rules.entries()) {
+              checkType(rule, "object", `${field}[${i}]`);
+              checkType(rule.field, "string", `${field}[${i}].field`);
+              checkType(rule.op, "string", `${field}[${i}].op`);
+              if (!ops.includes(rule.op)) {
+                throw new Error(`${field}[${i}].op must be one of ${ops.join(", ")}`);
+              }
+              if (rule.value === undefined) {
+                throw new Error(`${field}[${i}].value must be set`);
+              }
+              checkType(rule.reason, "string?", `${field}[${i}].reason`);
+            }
+          }
+        };
+        checkPolicyRules(args.configuration.policy.policyRules, "configuration.policy.policyRules");
+        checkType(args.configuration.policy.policyRoutes, "array?", "configuration.policy.policyRoutes");
+        if (args.configuration.policy.policyRoutes) {
+          const prefixes = new Set();
+          for (const [i, route] of args.configuration.policy.policyRoutes.entries()) {
+            checkType(route, "object", `configuration.policy.policyRoutes[${i}]`);
+            checkType(route.issuerPrefix, "string", `configuration.policy.policyRoutes[${i}].issuerPrefix`);
+            if (prefixes.has(route.issuerPrefix)) {
+              throw new Error(`configuration.policy.policyRoutes[${i}].issuerPrefix must be unique`);
+            }
+            prefixes.add(route.issuerPrefix);
+            checkType(route.policyScript, "string?", `configuration.policy.policyRoutes[${i}].policyScript`);
+            checkPolicyRules(route.policyRules, `configuration.policy.policyRoutes[${i}].policyRules`);
+          }
+        }
+        checkType(args.configuration.policy.acceptedIssuerPrefixes, "array?", "configuration.policy.acceptedIssuerPrefixes");
+        if (args.configuration.policy.acceptedIssuerPrefixes) {
+          for (const [i, prefix] of args.configuration.policy.acceptedIssuerPrefixes.entries()) {
+            checkType(prefix, "string", `configuration.policy.acceptedIssuerPrefixes[${i}]`);
+          }
+        }
+        for (const limit of ["maxX5chainLength", "maxProtectedHeaderBytes"]) {
+          checkType(args.configuration.policy[limit], "integer?", `configuration.policy.${limit}`);
+          if (args.configuration.policy[limit] !== undefined) {
+            checkBounds(args.configuration.policy[limit], 0, null, `configuration.policy.${limit}`);
+          }
+        }
       }
 
       checkType(args.configuration.authentication, "object?", "configuration.authentication");
@@ -30,6 +79,38 @@ actions.set("set_scitt_configuration",
         }
       }
 
+      checkType(args.configuration.logging, "object?", "configuration.logging");
+      if (args.configuration.logging) {
+        checkType(args.configuration.logging.sampling, "object?", "configuration.logging.sampling");
+        if (args.configuration.logging.sampling) {
+          for (const [path, rate] of Object.entries(args.configuration.logging.sampling)) {
+            checkType(rate, "number", `configuration.logging.sampling["${path}"]`);
+            checkBounds(rate, 0, 1, `configuration.logging.sampling["${path}"]`);
+          }
+        }
+        checkType(args.configuration.logging.compact, "boolean?", "configuration.logging.compact");
+        checkType(args.configuration.logging.slowRequestThresholdMs, "integer?", "configuration.logging.slowRequestThresholdMs");
+        if (args.configuration.logging.slowRequestThresholdMs !== undefined) {
+          checkBounds(args.configuration.logging.slowRequestThresholdMs, 0, null, "configuration.logging.slowRequestThresholdMs");
+        }
+      }
+
+      checkType(args.configuration.rateLimits, "object?", "configuration.rateLimits");
+      if (args.configuration.rateLimits) {
+        for (const key of ["perIssuer", "perSubject"]) {
+          const limit = args.configuration.rateLimits[key];
+          checkType(limit, "object?", `configuration.rateLimits.${key}`);
+          if (limit) {
+            checkType(limit.ratePerSecond, "number", `configuration.rateLimits.${key}.ratePerSecond`);
+            checkBounds(limit.ratePerSecond, 0, null, `configuration.rateLimits.${key}.ratePerSecond`);
+            checkType(limit.burst, "number?", `configuration.rateLimits.${key}.burst`);
+            if (limit.burst !== undefined) {
+              checkBounds(limit.burst, 1, null, `configuration.rateLimits.${key}.burst`);
+            }
+          }
+        }
+      }
+
       checkType(args.configuration.serviceIssuer, "string?", "configuration.serviceIssuer");
     },
     function(args) {
@@ -29,6 +29,15 @@ namespace scitt
     std::optional<std::string> request_id;
     std::optional<std::string> client_request_id;
     timespec start_time;
+    bool log_sampled = true;
+    bool log_compact = false;
+
+    // Used by the flight recorder
+    std::optional<std::string> issuer_type;
+
+    // Used by operations_endpoints.h, when the transaction records the time
+    // of synchronous operations.
+    std::optional<time_t> operation_clock_tick;
   };
 
   static AppData& get_app_data(const std::shared_ptr<ccf::RpcContext>& ctx)
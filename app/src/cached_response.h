@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <ccf/crypto/sha256_hash.h>
+#include <ccf/rpc_context.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scitt
+{
+  static constexpr auto ETAG_HEADER = "etag";
+  static constexpr auto IF_NONE_MATCH_HEADER = "if-none-match";
+
+  /**
+   * A response which was serialized ahead of time, and can be served as is to
+   * any number of requests until the data it was built from changes.
+   *
+   * Responses carry a strong ETag derived from their body, allowing clients
+   * to revalidate their copy with If-None-Match and get an empty
+   * 304 Not Modified response if it is still current.
+   */
+  class CachedResponse
+  {
+  public:
+    CachedResponse(std::vector<uint8_t> body, std::string content_type) :
+      body(std::move(body)),
+      content_type(std::move(content_type)),
+      etag(
+        fmt::format("\"{}\"", ccf::crypto::Sha256Hash(this->body).hex_str()))
+    {}
+
+    const std::vector<uint8_t>& get_body() const
+    {
+      return body;
+    }
+
+    const std::string& get_etag() const
+    {
+      return etag;
+    }
+
+    /**
+     * Check whether the value of an If-None-Match header matches the given
+     * ETag, in which case the client's copy is still current.
+     */
+    static bool matches(std::string_view if_none_match, std::string_view etag)
+    {
+      while (!if_none_match.empty())
+      {
+        const auto comma = if_none_match.find(',');
+        auto candidate = if_none_match.substr(0, comma);
+        if_none_match = comma == std::string_view::npos ?
+          std::string_view{} :
+          if_none_match.substr(comma + 1);
+
+        const auto first = candidate.find_first_not_of(" \t");
+        if (first == std::string_view::npos)
+        {
+          continue;
+        }
+        candidate = candidate.substr(
+          first, candidate.find_last_not_of(" \t") - first + 1);
+
+        // If-None-Match uses weak comparison, so weak validators match too.
+        if (candidate.starts_with("W/"))
+        {
+          candidate.remove_prefix(2);
+        }
+        if (candidate == "*" || candidate == etag)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /**
+     * Write this response to the RPC context, or a 304 Not Modified response
+     * if the request's If-None-Match header shows the client has it already.
+     */
+    void respond(ccf::RpcContext& rpc_ctx) const
+    {
+      rpc_ctx.set_response_header(ETAG_HEADER, etag);
+
+      auto if_none_match = rpc_ctx.get_request_header(IF_NONE_MATCH_HEADER);
+      if (if_none_match.has_value() && matches(if_none_match.value(), etag))
+      {
+        rpc_ctx.set_response_status(HTTP_STATUS_NOT_MODIFIED);
+        return;
+      }
+
+      rpc_ctx.set_response_status(HTTP_STATUS_OK);
+      rpc_ctx.set_response_header(
+        ccf::http::headers::CONTENT_TYPE, content_type);
+      rpc_ctx.set_response_body(body);
+    }
+
+  private:
+    std::vector<uint8_t> body;
+    std::string content_type;
+    std::string etag;
+  };
+
+  using CachedResponsePtr = std::shared_ptr<const CachedResponse>;
+
+  /**
+   * Holds the response built from the latest value of some input, such as a
+   * service certificate, and only rebuilds it when that input changes.
+   */
+  template <typename K>
+  class ResponseCache
+  {
+  public:
+    template <typename F>
+    CachedResponsePtr get(const K& key, F&& build)
+    {
+      {
+        std::lock_guard guard(lock);
+        if (response != nullptr && current_key == key)
+        {
+          return response;
+        }
+      }
+
+      // Build outside the lock. Concurrent requests may build the same
+      // response twice after a change, which is harmless.
+      CachedResponsePtr built = build();
+
+      std::lock_guard guard(lock);
+      current_key = key;
+      response = built;
+      return built;
+    }
+
+  private:
+    std::mutex lock;
+    K current_key = {};
+    CachedResponsePtr response;
+  };
+}
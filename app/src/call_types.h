@@ -3,6 +3,8 @@
 
 #pragma once
 #include "cbor.h"
+#include "flight_recorder.h"
+#include "issuer_costs.h"
 #include "kv_types.h"
 #include "odata_error.h"
 
@@ -63,6 +65,17 @@ namespace scitt
   DECLARE_JSON_OPTIONAL_FIELDS_WITH_RENAMES(
     GetEntriesTransactionIds::Out, next_link, "nextLink");
 
+  struct GetEntriesCount
+  {
+    struct Out
+    {
+      size_t count;
+    };
+  };
+
+  DECLARE_JSON_TYPE(GetEntriesCount::Out);
+  DECLARE_JSON_REQUIRED_FIELDS(GetEntriesCount::Out, count);
+
   struct GetVersion
   {
     struct Out
@@ -74,6 +87,68 @@ namespace scitt
   DECLARE_JSON_TYPE(GetVersion::Out);
   DECLARE_JSON_REQUIRED_FIELDS(GetVersion::Out, version);
 
+  DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(SlowRequest);
+  DECLARE_JSON_REQUIRED_FIELDS_WITH_RENAMES(
+    SlowRequest,
+    request_id,
+    "requestId",
+    verb,
+    "verb",
+    path,
+    "path",
+    status,
+    "status",
+    body_size,
+    "bodySize",
+    duration_us,
+    "durationUs",
+    stages_us,
+    "stagesUs");
+  DECLARE_JSON_OPTIONAL_FIELDS_WITH_RENAMES(
+    SlowRequest,
+    client_request_id,
+    "clientRequestId",
+    issuer_type,
+    "issuerType");
+
+  struct GetSlowRequests
+  {
+    struct Out
+    {
+      uint64_t total;
+      std::vector<SlowRequest> requests;
+    };
+  };
+
+  DECLARE_JSON_TYPE(GetSlowRequests::Out);
+  DECLARE_JSON_REQUIRED_FIELDS(GetSlowRequests::Out, total, requests);
+
+  DECLARE_JSON_TYPE(IssuerCost);
+  DECLARE_JSON_REQUIRED_FIELDS_WITH_RENAMES(
+    IssuerCost,
+    issuer,
+    "issuer",
+    count,
+    "count",
+    cpu_us,
+    "cpuUs",
+    bytes,
+    "bytes",
+    error_us,
+    "errorUs");
+
+  struct GetIssuerCosts
+  {
+    struct Out
+    {
+      size_t minutes;
+      std::vector<IssuerCost> issuers;
+    };
+  };
+
+  DECLARE_JSON_TYPE(GetIssuerCosts::Out);
+  DECLARE_JSON_REQUIRED_FIELDS(GetIssuerCosts::Out, minutes, issuers);
+
   struct GetOperation
   {
     struct Out
@@ -106,4 +181,29 @@ namespace scitt
       error_message_opt);
   }
 
+  /**
+   * The outcome of looking up one operation of a batch. Operation IDs which
+   * don't refer to any operation the service can report on, for instance
+   * because it has expired, have a lookup error instead.
+   */
+  struct OperationLookup
+  {
+    ccf::TxID operation_id;
+    std::optional<GetOperation::Out> operation;
+    std::optional<ODataError> lookup_error;
+  };
+
+  static std::vector<uint8_t> operation_lookup_to_cbor(
+    const OperationLookup& lookup)
+  {
+    if (lookup.operation.has_value())
+    {
+      return operation_to_cbor(lookup.operation.value());
+    }
+    return cbor::operation_lookup_error_to_cbor(
+      lookup.operation_id.to_str(),
+      lookup.lookup_error.value().code,
+      lookup.lookup_error.value().message);
+  }
+
 } // namespace scitt
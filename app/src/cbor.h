@@ -7,8 +7,10 @@
 #include <qcbor/UsefulBuf.h>
 #include <qcbor/qcbor_decode.h>
 #include <qcbor/qcbor_encode.h>
+#include <qcbor/qcbor_spiffy_decode.h>
 #include <span>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -154,6 +156,124 @@ namespace scitt::cbor
     return output;
   }
 
+  /**
+   * Encode an operation ID which couldn't be looked up, with the reason why,
+   * as an item of a batch of operations.
+   */
+  inline std::vector<uint8_t> operation_lookup_error_to_cbor(
+    const std::string& operation_id,
+    const std::string& error_code,
+    const std::string& error_message)
+  {
+    size_t approx_buff_size = 8 * QCBOR_HEAD_BUFFER_SIZE +
+      sizeof("OperationId") + sizeof("LookupError") + operation_id.size() +
+      error_code.size() + error_message.size();
+    std::vector<uint8_t> output(approx_buff_size);
+
+    UsefulBuf output_buf{output.data(), output.size()};
+    QCBOREncodeContext ectx;
+    QCBOREncode_Init(&ectx, output_buf);
+    QCBOREncode_OpenMap(&ectx);
+    QCBOREncode_AddTextToMap(&ectx, "OperationId", from_string(operation_id));
+    QCBOREncode_OpenMapInMap(&ectx, "LookupError");
+    QCBOREncode_AddTextToMapN(&ectx, CBOR_ERROR_TITLE, from_string(error_code));
+    QCBOREncode_AddTextToMapN(
+      &ectx, CBOR_ERROR_DETAIL, from_string(error_message));
+    QCBOREncode_CloseMap(&ectx);
+    QCBOREncode_CloseMap(&ectx);
+
+    UsefulBufC encoded_cbor;
+    QCBORError err;
+    err = QCBOREncode_Finish(&ectx, &encoded_cbor);
+    if (err != QCBOR_SUCCESS)
+    {
+      throw std::logic_error("Failed to encode CBOR error");
+    }
+    output.resize(encoded_cbor.len);
+    output.shrink_to_fit();
+    return output;
+  }
+
+  /**
+   * Wrap items which are already CBOR-encoded in a CBOR array.
+   */
+  inline std::vector<uint8_t> encoded_items_to_cbor_array(
+    const std::vector<std::vector<uint8_t>>& items)
+  {
+    size_t buff_size = QCBOR_HEAD_BUFFER_SIZE;
+    for (const auto& item : items)
+    {
+      buff_size += item.size();
+    }
+    std::vector<uint8_t> output(buff_size);
+
+    UsefulBuf output_buf{output.data(), output.size()};
+    QCBOREncodeContext ectx;
+    QCBOREncode_Init(&ectx, output_buf);
+    QCBOREncode_OpenArray(&ectx);
+    for (const auto& item : items)
+    {
+      QCBOREncode_AddEncoded(&ectx, from_bytes(item));
+    }
+    QCBOREncode_CloseArray(&ectx);
+
+    UsefulBufC encoded_cbor;
+    QCBORError err;
+    err = QCBOREncode_Finish(&ectx, &encoded_cbor);
+    if (err != QCBOR_SUCCESS)
+    {
+      throw std::logic_error("Failed to encode CBOR array");
+    }
+    output.resize(encoded_cbor.len);
+    output.shrink_to_fit();
+    return output;
+  }
+
+  /**
+   * Decode a CBOR array of text strings, with at most max_items items.
+   *
+   * Throws std::invalid_argument if the input is anything else.
+   */
+  inline std::vector<std::string> decode_text_array(
+    std::span<const uint8_t> data, size_t max_items)
+  {
+    QCBORDecodeContext ctx;
+    QCBORDecode_Init(&ctx, from_bytes(data), QCBOR_DECODE_MODE_NORMAL);
+    QCBORDecode_EnterArray(&ctx, nullptr);
+    if (QCBORDecode_GetError(&ctx) != QCBOR_SUCCESS)
+    {
+      throw std::invalid_argument("Input is not a CBOR array");
+    }
+
+    std::vector<std::string> result;
+    while (true)
+    {
+      QCBORItem item;
+      auto err = QCBORDecode_GetNext(&ctx, &item);
+      if (err == QCBOR_ERR_NO_MORE_ITEMS)
+      {
+        break;
+      }
+      if (err != QCBOR_SUCCESS || item.uDataType != QCBOR_TYPE_TEXT_STRING)
+      {
+        throw std::invalid_argument("Array item is not a text string");
+      }
+      if (result.size() >= max_items)
+      {
+        throw std::invalid_argument(
+          "Array has more than " + std::to_string(max_items) + " items");
+      }
+      result.emplace_back(as_string(item.val.string));
+    }
+    QCBORDecode_ExitArray(&ctx);
+
+    if (QCBORDecode_Finish(&ctx) != QCBOR_SUCCESS)
+    {
+      throw std::invalid_argument("Unexpected data after CBOR array");
+    }
+    return result;
+  }
+
   // see https://www.ietf.org/rfc/rfc9679.html#section-4.2
   inline std::vector<uint8_t> ec_cose_key_to_cbor(
     const int64_t kty,
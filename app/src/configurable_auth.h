@@ -3,33 +3,206 @@
 
 #pragma once
 
+#include "historical/lru.h"
 #include "kv_types.h"
+#include "metrics.h"
 
+#include <ccf/base_endpoint_registry.h>
 #include <ccf/common_auth_policies.h>
+#include <ccf/crypto/sha256_hash.h>
 #include <ccf/rpc_context.h>
+#include <ccf/service/tables/jwt.h>
+#include <functional>
+#include <mutex>
 
 namespace scitt
 {
+  /**
+   * JWTs which were successfully verified, keyed by the digest of the
+   * 'Authorization' header they were presented in, along with the outcome of
+   * the claims check.
+   *
+   * An entry is only used until the token expires, the configuration
+   * changes, or the signing key it was verified with is updated or removed.
+   * Entries found to be stale are removed.
+   */
+  class VerifiedJwtCache
+  {
+  public:
+    using TokenDigest = ccf::crypto::Sha256Hash::Representation;
+
+    // Version of the last write to a signing key's metadata, if any.
+    using GetKeyVersion = std::function<std::optional<ccf::kv::Version>(
+      const std::string& key_id)>;
+
+    struct Entry
+    {
+      ccf::JwtAuthnIdentity identity;
+      std::optional<std::string> claims_error;
+
+      // Validity conditions of the entry
+      time_t expiry;
+      std::optional<ccf::kv::Version> config_version;
+      std::string key_id;
+      std::optional<ccf::kv::Version> key_version;
+    };
+
+    VerifiedJwtCache(size_t max_entries) : cache(max_entries) {}
+
+    static TokenDigest get_digest(const std::string& authorization_header)
+    {
+      return ccf::crypto::Sha256Hash(authorization_header).h;
+    }
+
+    std::shared_ptr<const Entry> lookup(
+      const TokenDigest& digest,
+      time_t now,
+      std::optional<ccf::kv::Version> config_version,
+      const GetKeyVersion& get_key_version)
+    {
+      std::shared_ptr<const Entry> entry;
+      {
+        std::lock_guard guard(lock);
+        auto it = cache.find(digest);
+        if (it == cache.end())
+        {
+          return nullptr;
+        }
+        entry = it->second;
+      }
+
+      bool valid = now < entry->expiry &&
+        entry->config_version == config_version &&
+        entry->key_version == get_key_version(entry->key_id);
+
+      std::lock_guard guard(lock);
+      if (valid)
+      {
+        // Inserting an existing key only marks it as recently used.
+        cache.insert(digest, std::shared_ptr<const Entry>(entry));
+        return entry;
+      }
+      else
+      {
+        cache.erase(digest);
+        return nullptr;
+      }
+    }
+
+    void store(
+      const TokenDigest& digest,
+      std::optional<ccf::kv::Version> config_version,
+      const ccf::JwtAuthnIdentity& identity,
+      const std::optional<std::string>& claims_error,
+      const GetKeyVersion& get_key_version)
+    {
+      // Tokens without an expiry time or key ID can't be safely remembered.
+      auto exp = identity.payload.find("exp");
+      auto kid = identity.header.find("kid");
+      if (
+        exp == identity.payload.end() || !exp->is_number_integer() ||
+        kid == identity.header.end() || !kid->is_string())
+      {
+        return;
+      }
+
+      auto entry = std::make_shared<const Entry>(Entry{
+        .identity = identity,
+        .claims_error = claims_error,
+        .expiry = exp->get<time_t>(),
+        .config_version = config_version,
+        .key_id = kid->get<std::string>(),
+        .key_version = get_key_version(kid->get<std::string>()),
+      });
+
+      std::lock_guard guard(lock);
+      cache.erase(digest);
+      cache.insert(digest, std::move(entry));
+    }
+
+    size_t size()
+    {
+      std::lock_guard guard(lock);
+      return cache.size();
+    }
+
+  private:
+    std::mutex lock;
+    LRU<TokenDigest, std::shared_ptr<const Entry>> cache;
+  };
+
   /**
    * Authentication policy that requires a JWT 'Authorization' header.
    *
    * The policy is only active if enabled by the service configuration.
    * In addition to being signed appropriately, tokens must contain the minimum
    * set of claims required by the configuration.
+   *
+   * Clients commonly reuse the same token for many requests. Tokens which
+   * were successfully verified are remembered in a VerifiedJwtCache, so that
+   * repeated requests skip signature verification.
    */
   class ConfigurableJwtAuthnPolicy : public ccf::JwtAuthnPolicy
   {
   public:
+    static constexpr size_t MAX_CACHED_TOKENS = 1000;
+
+    ConfigurableJwtAuthnPolicy(
+      std::function<ccf::ApiResult(timespec& time)> get_time) :
+      get_time(std::move(get_time)),
+      cache(MAX_CACHED_TOKENS),
+      cache_hits(metrics::registry().counter(
+        "scitt_jwt_cache_hits_total",
+        "Number of JWTs accepted without verifying their signature again")),
+      cache_misses(metrics::registry().counter(
+        "scitt_jwt_cache_misses_total",
+        "Number of JWTs which had to be fully verified"))
+    {}
+
     std::unique_ptr<ccf::AuthnIdentity> authenticate(
       ccf::kv::ReadOnlyTx& tx,
       const std::shared_ptr<ccf::RpcContext>& ctx,
       std::string& error_reason) override
     {
-      auto identity = JwtAuthnPolicy::authenticate(tx, ctx, error_reason);
-      if (!identity)
+      auto handle = tx.template ro<ConfigurationTable>(CONFIGURATION_TABLE);
+      auto config_version = handle->get_version_of_previous_write();
+
+      const auto get_key_version = [&tx](const std::string& key_id) {
+        auto keys = tx.template ro<ccf::JwtPublicSigningKeysMetadata>(
+          ccf::Tables::JWT_PUBLIC_SIGNING_KEYS_METADATA);
+        return keys->get_version_of_previous_write(key_id);
+      };
+
+      std::optional<VerifiedJwtCache::TokenDigest> token_digest;
+      if (auto header =
+            ctx->get_request_header(ccf::http::headers::AUTHORIZATION))
       {
-        log_auth_error(ctx, error_reason);
-        return nullptr;
+        token_digest = VerifiedJwtCache::get_digest(header.value());
+      }
+
+      std::shared_ptr<const VerifiedJwtCache::Entry> cached;
+      timespec time;
+      if (token_digest.has_value() && get_time(time) == ccf::ApiResult::OK)
+      {
+        cached = cache.lookup(
+          token_digest.value(), time.tv_sec, config_version, get_key_version);
+      }
+
+      std::unique_ptr<ccf::AuthnIdentity> identity;
+      if (cached)
+      {
+        cache_hits.increment();
+        identity = std::make_unique<ccf::JwtAuthnIdentity>(cached->identity);
+      }
+      else
+      {
+        cache_misses.increment();
+        identity = JwtAuthnPolicy::authenticate(tx, ctx, error_reason);
+        if (!identity)
+        {
+          log_auth_error(ctx, error_reason);
+          return nullptr;
+        }
       }
 
       const auto* jwt =
@@ -39,7 +212,6 @@ namespace scitt
         throw std::logic_error("JwtAuthnPolicy returned a bad identity type.");
       }
 
-      auto handle = tx.template ro<ConfigurationTable>(CONFIGURATION_TABLE);
       auto cfg = handle->get().value_or(Configuration{});
       const auto& required_claims = cfg.authentication.jwt.required_claims;
       if (!required_claims.is_object())
@@ -49,15 +221,36 @@ namespace scitt
         return nullptr;
       }
 
-      if (check_claims(jwt->payload, required_claims, error_reason))
+      std::optional<std::string> claims_error;
+      if (cached)
       {
-        return identity;
+        claims_error = cached->claims_error;
       }
       else
       {
+        std::string claims_error_reason;
+        if (!check_claims(jwt->payload, required_claims, claims_error_reason))
+        {
+          claims_error = claims_error_reason;
+        }
+        if (token_digest.has_value())
+        {
+          cache.store(
+            token_digest.value(),
+            config_version,
+            *jwt,
+            claims_error,
+            get_key_version);
+        }
+      }
+
+      if (claims_error.has_value())
+      {
+        error_reason = claims_error.value();
         log_auth_error(ctx, error_reason);
         return nullptr;
       }
+      return identity;
     }
 
     static bool check_claims(
@@ -97,6 +290,13 @@ namespace scitt
         ctx->get_request_header("x-ms-client-request-id").value_or(""),
         error_reason);
     }
+
+  private:
+    std::function<ccf::ApiResult(timespec& time)> get_time;
+    VerifiedJwtCache cache;
+
+    metrics::Counter& cache_hits;
+    metrics::Counter& cache_misses;
   };
 
   /**
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "kv_types.h"
+
+#include <ccf/tx.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace scitt
+{
+  /**
+   * A value derived from the service configuration, such as settings needed
+   * by every request or a compiled form of the policy. The value is only
+   * derived again when the configuration changes.
+   */
+  template <typename T>
+  class ConfigurationCache
+  {
+  public:
+    using Derive = std::function<T(const Configuration&)>;
+
+    explicit ConfigurationCache(Derive derive) : derive(std::move(derive)) {}
+
+    /**
+     * Get the value derived from the configuration seen by the given
+     * transaction. Exceptions thrown while deriving it are propagated, and
+     * nothing is cached.
+     */
+    std::shared_ptr<const T> get(ccf::kv::ReadOnlyTx& tx)
+    {
+      auto handle = tx.template ro<ConfigurationTable>(CONFIGURATION_TABLE);
+      auto version = handle->get_version_of_previous_write();
+      {
+        std::lock_guard guard(lock);
+        if (value != nullptr && version == value_version)
+        {
+          return value;
+        }
+      }
+
+      auto derived = std::make_shared<const T>(
+        derive(handle->get().value_or(Configuration{})));
+
+      std::lock_guard guard(lock);
+      value_version = version;
+      value = derived;
+      return derived;
+    }
+
+  private:
+    Derive derive;
+    std::mutex lock;
+    std::optional<ccf::kv::Version> value_version;
+    std::shared_ptr<const T> value;
+  };
+}
@@ -15,6 +15,17 @@ namespace scitt
 
   const std::chrono::seconds OPERATION_EXPIRY{60 * 60};
 
+  // Maximum interval between two synchronous registrations on a node that
+  // record their time in the operations table.
+  const std::chrono::seconds OPERATION_CLOCK_TICK_INTERVAL{1};
+
+  const size_t MAX_OPERATIONS_PER_BATCH = 1000;
+
+  // Longest a request to /operations/{txid} may wait for the operation to
+  // complete, and how many such requests a node holds on to at once.
+  const std::chrono::seconds MAX_OPERATION_WAIT{30};
+  const size_t MAX_WAITING_OPERATION_REQUESTS = 1000;
+
   namespace errors
   {
     const std::string IndexingInProgressRetryLater =
@@ -28,12 +39,17 @@ namespace scitt
     const std::string OperationExpired = "OperationExpired";
     const std::string PolicyError = "PolicyError";
     const std::string PolicyFailed = "PolicyFailed";
+    const std::string TooManyRequests = "TooManyRequests";
   } // namespace errors
 
   namespace indexing
   {
     const size_t SEQNOS_PER_BUCKET = 10000;
-    const size_t MAX_BUCKETS = 20;
+
+    // Memory budget of the compressed entry index. Buckets are evicted, oldest
+    // first, when they no longer fit. The per-bucket entry counts are kept
+    // outside of this budget, at 4 bytes per SEQNOS_PER_BUCKET transactions.
+    const size_t MAX_RESIDENT_BYTES = 16 * 1024 * 1024;
   }
 
 } // namespace scitt
@@ -323,6 +323,13 @@ namespace scitt::cose
 
     // Microsoft Trusted Signing Service (TSS) parameters
     TSSMap tss_map;
+
+    // Size of the encoded protected header, in bytes
+    size_t encoded_size = 0;
+
+    // Encoded protected header. This refers to the buffer it was decoded
+    // from, and is only valid for as long as that buffer.
+    std::span<const uint8_t> encoded;
   };
 
   struct UnprotectedHeader
@@ -398,7 +405,11 @@ namespace scitt::cose
 
     QCBORError qcbor_result;
 
-    QCBORDecode_EnterBstrWrapped(&ctx, QCBOR_TAG_REQUIREMENT_NOT_A_TAG, NULL);
+    UsefulBufC encoded = NULLUsefulBufC;
+    QCBORDecode_EnterBstrWrapped(
+      &ctx, QCBOR_TAG_REQUIREMENT_NOT_A_TAG, &encoded);
+    parsed.encoded_size = encoded.len;
+    parsed.encoded = {static_cast<const uint8_t*>(encoded.ptr), encoded.len};
     QCBORDecode_EnterMap(&ctx, NULL);
 
     enum
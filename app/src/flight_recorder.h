@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "timing.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace scitt
+{
+  /**
+   * A request which took longer than the configured threshold, along with
+   * the time spent in each stage of its processing.
+   */
+  struct SlowRequest
+  {
+    std::string request_id;
+    std::optional<std::string> client_request_id;
+    std::string verb;
+    std::string path;
+    int status = 0;
+    size_t body_size = 0;
+
+    /**
+     * DID method of the statement issuer, eg. "did:x509", if the request
+     * got far enough to find it.
+     */
+    std::optional<std::string> issuer_type;
+
+    uint64_t duration_us = 0;
+
+    /**
+     * Microseconds spent in each stage which was entered, by stage name.
+     */
+    std::map<std::string, uint64_t> stages_us;
+
+    void set_stages(const timing::StageTimings& timings)
+    {
+      for (size_t i = 0; i < timing::STAGE_COUNT; i++)
+      {
+        if (timings.recorded[i])
+        {
+          stages_us[std::string(timing::STAGE_NAMES[i])] =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+              timings.durations[i])
+              .count();
+        }
+      }
+    }
+  };
+
+  /**
+   * A fixed-size ring buffer of the most recent slow requests handled by this
+   * node.
+   *
+   * Only requests which exceed the threshold are recorded, so the lock is
+   * rarely taken on the request path.
+   */
+  class FlightRecorder
+  {
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    FlightRecorder(size_t capacity = DEFAULT_CAPACITY) : capacity(capacity)
+    {
+      buffer.reserve(capacity);
+    }
+
+    void record(SlowRequest request)
+    {
+      std::lock_guard guard(lock);
+      total++;
+      if (buffer.size() < capacity)
+      {
+        buffer.push_back(std::move(request));
+      }
+      else
+      {
+        buffer[next] = std::move(request);
+      }
+      next = (next + 1) % capacity;
+    }
+
+    /**
+     * Get the recorded requests, most recent first.
+     */
+    std::vector<SlowRequest> get_recent() const
+    {
+      std::lock_guard guard(lock);
+      std::vector<SlowRequest> out;
+      out.reserve(buffer.size());
+      for (size_t i = 0; i < buffer.size(); i++)
+      {
+        out.push_back(buffer[(next + capacity - 1 - i) % capacity]);
+      }
+      return out;
+    }
+
+    /**
+     * Number of requests recorded since the node started, including the ones
+     * which have since been overwritten.
+     */
+    uint64_t get_total() const
+    {
+      std::lock_guard guard(lock);
+      return total;
+    }
+
+  private:
+    size_t capacity;
+
+    mutable std::mutex lock;
+    std::vector<SlowRequest> buffer;
+    size_t next = 0;
+    uint64_t total = 0;
+  };
+
+  /**
+   * The slow requests recorded by this node.
+   */
+  inline FlightRecorder& flight_recorder()
+  {
+    static FlightRecorder instance;
+    return instance;
+  }
+}
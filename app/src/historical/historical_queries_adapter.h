@@ -4,6 +4,7 @@
 
 #include "http_error.h"
 #include "lru.h"
+#include "metrics.h"
 #include "tracing.h"
 
 #include <ccf/endpoint_context.h>
@@ -46,6 +47,17 @@ namespace scitt::historical
     const CheckHistoricalTxStatus& available,
     EndpointContext& ctx)
   {
+    static auto& hits = metrics::registry().counter(
+      "scitt_historical_state_hits_total",
+      "Number of historical queries answered from cached state");
+    static auto& misses = metrics::registry().counter(
+      "scitt_historical_state_misses_total",
+      "Number of historical queries which had to wait for state to be "
+      "fetched");
+    static auto& evictions = metrics::registry().counter(
+      "scitt_historical_state_evictions_total",
+      "Number of historical states dropped from the cache");
+
     // Extract the requested transaction ID
     auto tx_id_str = ctx.rpc_ctx->get_request_path_params().at("txid");
     const auto tx_id = ccf::TxID::from_str(tx_id_str);
@@ -98,6 +110,7 @@ namespace scitt::historical
         [&state_cache](ccf::SeqNo key, bool value) {
           SCITT_INFO("Dropping cached transaction {}", key);
           state_cache.drop_cached_states(key);
+          evictions.increment();
         });
       ACTIVE_HANDLES_LRU.insert(historic_request_handle, true);
 
@@ -110,6 +123,7 @@ namespace scitt::historical
 
     if (historical_state == nullptr)
     {
+      misses.increment();
       constexpr uint32_t retry_after_seconds = 1;
       throw ServiceUnavailableCborError(
         errors::TransactionNotCached,
@@ -118,6 +132,7 @@ namespace scitt::historical
         retry_after_seconds);
     }
 
+    hits.increment();
     return historical_state;
   }
 
@@ -142,6 +142,20 @@ public:
     return it->second;
   }
 
+  /**
+   * Remove an entry from the cache, if present. The cull callback is not
+   * called, since the entry is not being evicted.
+   */
+  void erase(const K& k)
+  {
+    const auto it = iter_map.find(k);
+    if (it != iter_map.end())
+    {
+      entries_list.erase(it->second);
+      iter_map.erase(it);
+    }
+  }
+
   void clear()
   {
     entries_list.clear();
@@ -59,6 +59,13 @@ namespace scitt
     {}
   };
 
+  struct NotAcceptableJsonError : public HTTPError
+  {
+    NotAcceptableJsonError(std::string code, std::string msg) :
+      HTTPError(HTTP_STATUS_NOT_ACCEPTABLE, code, msg, false)
+    {}
+  };
+
   struct NotFoundCborError : public HTTPError
   {
     NotFoundCborError(std::string code, std::string msg) :
@@ -122,6 +129,19 @@ namespace scitt
     }
   };
 
+  struct TooManyRequestsCborError : public HTTPError
+  {
+    TooManyRequestsCborError(
+      std::string code, std::string msg, uint32_t retry_after) :
+      HTTPError(
+        HTTP_STATUS_TOO_MANY_REQUESTS,
+        code,
+        msg,
+        true,
+        {{"Retry-After", std::to_string(retry_after)}})
+    {}
+  };
+
   struct InternalServerError : public HTTPError
   {
     InternalServerError(
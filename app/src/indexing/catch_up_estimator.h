@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+
+#include <algorithm>
+#include <ccf/tx_id.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace scitt::indexing
+{
+  /**
+   * Estimates how quickly an indexing strategy is catching up with the ledger,
+   * in sequence numbers per second.
+   *
+   * This is used to tell clients how long to wait before retrying a query
+   * that can't be answered yet, rather than having them poll every second
+   * while a node indexes a large ledger after starting up.
+   *
+   * Samples are taken whenever an estimate is requested while the strategy is
+   * behind its target, at most once per sampling interval, and the rate is
+   * smoothed exponentially. Samples are discarded once the strategy has
+   * caught up, or when they get too old, so that a ledger which was idle
+   * isn't mistaken for a stalled index.
+   */
+  class CatchUpEstimator
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr auto SAMPLING_INTERVAL = std::chrono::seconds(1);
+    static constexpr auto MAX_SAMPLE_AGE = std::chrono::seconds(10);
+    static constexpr uint32_t MIN_RETRY_AFTER_SECONDS = 1;
+    static constexpr uint32_t MAX_RETRY_AFTER_SECONDS = 60;
+
+    /**
+     * Record the current watermark of the strategy, and return the number of
+     * seconds after which it is expected to reach the target.
+     */
+    uint32_t retry_after_seconds(
+      ccf::SeqNo indexed,
+      ccf::SeqNo target,
+      Clock::time_point now = Clock::now())
+    {
+      std::lock_guard guard(lock);
+
+      if (target <= indexed)
+      {
+        last_sample.reset();
+        return MIN_RETRY_AFTER_SECONDS;
+      }
+
+      if (
+        !last_sample.has_value() || indexed < last_sample->seqno ||
+        now - last_sample->time > MAX_SAMPLE_AGE)
+      {
+        last_sample = {indexed, now};
+      }
+      else if (now - last_sample->time >= SAMPLING_INTERVAL)
+      {
+        const std::chrono::duration<double> elapsed = now - last_sample->time;
+        const double rate = (indexed - last_sample->seqno) / elapsed.count();
+        smoothed_rate = smoothed_rate.has_value() ?
+          (smoothed_rate.value() + rate) / 2 :
+          rate;
+        last_sample = {indexed, now};
+      }
+
+      if (!smoothed_rate.has_value())
+      {
+        return MIN_RETRY_AFTER_SECONDS;
+      }
+      if (smoothed_rate.value() <= 0)
+      {
+        return MAX_RETRY_AFTER_SECONDS;
+      }
+
+      const double seconds =
+        std::ceil((target - indexed) / smoothed_rate.value());
+      return static_cast<uint32_t>(std::clamp(
+        seconds,
+        static_cast<double>(MIN_RETRY_AFTER_SECONDS),
+        static_cast<double>(MAX_RETRY_AFTER_SECONDS)));
+    }
+
+    /**
+     * Last known indexing rate, in sequence numbers per second.
+     */
+    std::optional<double> get_rate() const
+    {
+      std::lock_guard guard(lock);
+      return smoothed_rate;
+    }
+
+  private:
+    struct Sample
+    {
+      ccf::SeqNo seqno;
+      Clock::time_point time;
+    };
+
+    std::optional<Sample> last_sample;
+    std::optional<double> smoothed_rate;
+
+    mutable std::mutex lock;
+  };
+}
@@ -0,0 +1,370 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+
+#include "catch_up_estimator.h"
+#include "kv_types.h"
+#include "seqno_posting_list.h"
+
+#include <ccf/historical_queries_interface.h>
+#include <ccf/indexing/strategies/visit_each_entry_in_map.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+namespace scitt::indexing
+{
+  /**
+   * An indexing strategy which records the sequence numbers of all the
+   * transactions that wrote to the entry table.
+   *
+   * Sequence numbers are grouped into buckets of a fixed size, each stored as a
+   * compressed posting list. Buckets are kept in memory for as long as they fit
+   * in a budget expressed in bytes, evicting the oldest ones first. Ranges
+   * which are no longer resident are served by fetching their transactions
+   * from the host on demand, so the ledger is only ever indexed once.
+   *
+   * The number of entries in every bucket is kept forever, at 4 bytes per
+   * bucket, such that counting the entries in a range only needs to look at
+   * the buckets at its edges. This is outside of the resident budget, and is
+   * reported separately by describe().
+   */
+  class EntrySeqnoIndexingStrategy
+    : public ccf::indexing::strategies::VisitEachEntryInMap
+  {
+  public:
+    /**
+     * Get the sequence numbers of the entries in an inclusive range, or
+     * std::nullopt if they are still being fetched.
+     */
+    using Fallback = std::function<std::optional<std::vector<ccf::SeqNo>>(
+      ccf::SeqNo from, ccf::SeqNo to)>;
+
+    EntrySeqnoIndexingStrategy(
+      ccf::historical::AbstractStateCache& state_cache,
+      size_t seqnos_per_bucket,
+      size_t max_resident_bytes) :
+      EntrySeqnoIndexingStrategy(
+        [&state_cache](ccf::SeqNo from, ccf::SeqNo to)
+          -> std::optional<std::vector<ccf::SeqNo>> {
+          const auto handle = EVICTED_RANGE_HANDLES | from;
+          const auto stores = state_cache.get_store_range(handle, from, to);
+          if (stores.empty())
+          {
+            return std::nullopt;
+          }
+
+          std::vector<ccf::SeqNo> seqnos;
+          for (size_t i = 0; i < stores.size(); i++)
+          {
+            auto tx = stores[i]->create_read_only_tx();
+            if (tx.template ro<EntryTable>(ENTRY_TABLE)->has())
+            {
+              seqnos.push_back(from + i);
+            }
+          }
+          state_cache.drop_cached_states(handle);
+          return seqnos;
+        },
+        seqnos_per_bucket,
+        max_resident_bytes)
+    {}
+
+    EntrySeqnoIndexingStrategy(
+      Fallback fallback,
+      size_t seqnos_per_bucket,
+      size_t max_resident_bytes) :
+      VisitEachEntryInMap(ENTRY_TABLE),
+      fallback(std::move(fallback)),
+      seqnos_per_bucket(seqnos_per_bucket),
+      max_resident_bytes(max_resident_bytes)
+    {}
+
+    /**
+     * Get the sequence numbers of the entries in the inclusive range
+     * [from, to].
+     *
+     * Returns std::nullopt if some of the range isn't available yet, either
+     * because it hasn't been indexed or because its transactions are still
+     * being fetched from the host. The caller should retry later.
+     */
+    std::optional<std::vector<ccf::SeqNo>> get_write_txs_in_range(
+      ccf::SeqNo from, ccf::SeqNo to) const
+    {
+      std::vector<ccf::SeqNo> result;
+
+      const auto resident_from = get_resident_from();
+      if (from < resident_from)
+      {
+        const auto fallback_seqnos =
+          fallback(from, std::min(to, resident_from - 1));
+        if (!fallback_seqnos.has_value())
+        {
+          return std::nullopt;
+        }
+        result.insert(
+          result.end(), fallback_seqnos->begin(), fallback_seqnos->end());
+        from = resident_from;
+      }
+
+      if (from <= to)
+      {
+        std::lock_guard guard(lock);
+        if (from < first_resident_bucket * seqnos_per_bucket)
+        {
+          // Buckets were evicted since we last looked.
+          return std::nullopt;
+        }
+
+        const auto first_bucket = from / seqnos_per_bucket;
+        const auto last_bucket = to / seqnos_per_bucket;
+        for (auto it = resident_buckets.lower_bound(first_bucket);
+             it != resident_buckets.end() && it->first <= last_bucket;
+             it++)
+        {
+          it->second.for_each_in_range(from, to, [&result](ccf::SeqNo seqno) {
+            result.push_back(seqno);
+          });
+        }
+      }
+
+      return result;
+    }
+
+    /**
+     * Count the entries in the inclusive range [from, to].
+     *
+     * Returns std::nullopt under the same conditions as
+     * get_write_txs_in_range().
+     */
+    std::optional<size_t> count_write_txs_in_range(
+      ccf::SeqNo from, ccf::SeqNo to) const
+    {
+      // Buckets entirely contained in the range are counted from the
+      // per-bucket totals. Only the edges of the range, which cover part of a
+      // bucket, need looking at individual entries.
+      const size_t first_bucket =
+        (from + seqnos_per_bucket - 1) / seqnos_per_bucket;
+      const size_t end_bucket = (to + 1) / seqnos_per_bucket;
+      if (first_bucket >= end_bucket)
+      {
+        // No bucket is entirely contained in the range, but it may still
+        // straddle the boundary between two of them.
+        const ccf::SeqNo boundary =
+          (from / seqnos_per_bucket + 1) * seqnos_per_bucket;
+        if (to < boundary)
+        {
+          return count_in_partial_bucket(from, to);
+        }
+        const auto left = count_in_partial_bucket(from, boundary - 1);
+        const auto right = count_in_partial_bucket(boundary, to);
+        if (!left.has_value() || !right.has_value())
+        {
+          return std::nullopt;
+        }
+        return left.value() + right.value();
+      }
+
+      size_t count = 0;
+      {
+        std::lock_guard guard(lock);
+        const auto begin = std::min(first_bucket, bucket_counts.size());
+        const auto end = std::min(end_bucket, bucket_counts.size());
+        count = std::accumulate(
+          bucket_counts.begin() + begin,
+          bucket_counts.begin() + end,
+          size_t{0});
+      }
+
+      const ccf::SeqNo buckets_begin = first_bucket * seqnos_per_bucket;
+      const ccf::SeqNo buckets_end = end_bucket * seqnos_per_bucket;
+      std::optional<size_t> left_edge = 0;
+      if (from < buckets_begin)
+      {
+        left_edge = count_in_partial_bucket(from, buckets_begin - 1);
+      }
+      std::optional<size_t> right_edge = 0;
+      if (to >= buckets_end)
+      {
+        right_edge = count_in_partial_bucket(buckets_end, to);
+      }
+      if (!left_edge.has_value() || !right_edge.has_value())
+      {
+        return std::nullopt;
+      }
+
+      return count + left_edge.value() + right_edge.value();
+    }
+
+    /**
+     * Start fetching the parts of a range that are not resident, so that a
+     * later query over it doesn't have to wait.
+     */
+    void prefetch_range(ccf::SeqNo from, ccf::SeqNo to) const
+    {
+      const auto resident_from = get_resident_from();
+      if (from < resident_from)
+      {
+        fallback(from, std::min(to, resident_from - 1));
+      }
+    }
+
+    /**
+     * Number of bytes used by the resident buckets.
+     */
+    size_t get_resident_bytes() const
+    {
+      std::lock_guard guard(lock);
+      return resident_bytes;
+    }
+
+    /**
+     * Number of seconds after which the index is expected to have reached the
+     * given sequence number, for use in a Retry-After header.
+     */
+    uint32_t get_retry_after_seconds(ccf::SeqNo target)
+    {
+      return catch_up.retry_after_seconds(
+        get_indexed_watermark().seqno, target);
+    }
+
+    nlohmann::json describe() override
+    {
+      auto j = VisitEachEntryInMap::describe();
+      {
+        std::lock_guard guard(lock);
+        j["resident_bytes"] = resident_bytes;
+        j["resident_from_seqno"] = first_resident_bucket * seqnos_per_bucket;
+        j["bucket_count"] = bucket_counts.size();
+        j["bucket_count_bytes"] =
+          bucket_counts.capacity() * sizeof(uint32_t);
+      }
+      if (auto rate = catch_up.get_rate(); rate.has_value())
+      {
+        j["seqnos_per_second"] = rate.value();
+      }
+      return j;
+    }
+
+  protected:
+    void visit_entry(
+      const ccf::TxID& tx_id,
+      const ccf::ByteVector& k,
+      const ccf::ByteVector& v) override
+    {
+      std::lock_guard guard(lock);
+
+      const size_t bucket = tx_id.seqno / seqnos_per_bucket;
+      if (bucket >= bucket_counts.size())
+      {
+        bucket_counts.resize(bucket + 1, 0);
+      }
+      bucket_counts[bucket]++;
+
+      auto it = resident_buckets.find(bucket);
+      if (it == resident_buckets.end())
+      {
+        // The previous bucket is complete, and won't be appended to anymore.
+        if (!resident_buckets.empty())
+        {
+          auto& previous = resident_buckets.rbegin()->second;
+          resident_bytes -= previous.size_bytes();
+          previous.shrink_to_fit();
+          resident_bytes += previous.size_bytes();
+        }
+
+        it = resident_buckets
+               .emplace(bucket, SeqNoPostingList(bucket * seqnos_per_bucket))
+               .first;
+        resident_bytes += it->second.size_bytes();
+      }
+
+      resident_bytes -= it->second.size_bytes();
+      it->second.append(tx_id.seqno);
+      resident_bytes += it->second.size_bytes();
+
+      evict_buckets();
+    }
+
+  private:
+    // Historical query handles used to fetch evicted ranges, one per start of
+    // range. The top bit keeps them apart from the handles used by endpoints,
+    // which are sequence numbers.
+    static constexpr ccf::historical::RequestHandle EVICTED_RANGE_HANDLES =
+      ccf::historical::RequestHandle{1} << 63;
+
+    const Fallback fallback;
+    const size_t seqnos_per_bucket;
+    const size_t max_resident_bytes;
+
+    // Compressed sequence numbers of the most recent buckets, indexed by
+    // seqno / seqnos_per_bucket.
+    std::map<size_t, SeqNoPostingList> resident_buckets;
+    size_t resident_bytes = 0;
+
+    // Buckets before this one have been evicted, and are only available
+    // through the fallback index.
+    size_t first_resident_bucket = 0;
+
+    // Number of entries in each bucket, resident or not. This grows with the
+    // ledger, by 4 bytes every seqnos_per_bucket transactions, and is not
+    // counted in resident_bytes.
+    std::vector<uint32_t> bucket_counts;
+
+    CatchUpEstimator catch_up;
+
+    mutable std::mutex lock;
+
+    ccf::SeqNo get_resident_from() const
+    {
+      std::lock_guard guard(lock);
+      return first_resident_bucket * seqnos_per_bucket;
+    }
+
+    /**
+     * Count the entries in a range which does not span more than one bucket.
+     */
+    std::optional<size_t> count_in_partial_bucket(
+      ccf::SeqNo from, ccf::SeqNo to) const
+    {
+      {
+        std::lock_guard guard(lock);
+        if (from >= first_resident_bucket * seqnos_per_bucket)
+        {
+          auto it = resident_buckets.find(from / seqnos_per_bucket);
+          if (it == resident_buckets.end())
+          {
+            return 0;
+          }
+          return it->second.count_in_range(from, to);
+        }
+      }
+
+      const auto seqnos = fallback(from, to);
+      if (!seqnos.has_value())
+      {
+        return std::nullopt;
+      }
+      return seqnos->size();
+    }
+
+    /**
+     * Evict the oldest buckets until the resident ones fit in the budget. The
+     * most recent bucket is never evicted, since it is still being appended
+     * to.
+     */
+    void evict_buckets()
+    {
+      while (resident_bytes > max_resident_bytes && resident_buckets.size() > 1)
+      {
+        auto oldest = resident_buckets.begin();
+        resident_bytes -= oldest->second.size_bytes();
+        resident_buckets.erase(oldest);
+        first_resident_bucket = resident_buckets.begin()->first;
+      }
+    }
+  };
+}
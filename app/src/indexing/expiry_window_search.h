@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+
+#include <ccf/tx_id.h>
+#include <ctime>
+#include <optional>
+
+namespace scitt::indexing
+{
+  /**
+   * Binary search for the first transaction of the ledger which records an
+   * operation created at or after a cutoff time.
+   *
+   * Operation creation times are non-decreasing along the ledger, but most
+   * transactions don't record an operation. When a probed transaction doesn't
+   * record one, the search steps forward until it finds one, or reaches the
+   * end of the interval being searched. Skipped transactions don't record any
+   * operation, so starting to index from the probe is equivalent to starting
+   * from the operation found after it.
+   *
+   * The caller fetches the transaction returned by next_probe(), passes its
+   * contents to record(), and repeats until done() returns true. A caller
+   * which knows where the next operation is, for instance from an index of
+   * the writes to the operations table, should skip_to() it first rather
+   * than fetch every transaction in between.
+   */
+  class ExpiryWindowSearch
+  {
+  public:
+    /**
+     * Search the half-open interval [begin, end). If no transaction in it
+     * records a recent enough operation, the result is end.
+     */
+    ExpiryWindowSearch(ccf::SeqNo begin, ccf::SeqNo end, time_t cutoff) :
+      lo(begin),
+      hi(end),
+      cutoff(cutoff)
+    {
+      start_probe();
+    }
+
+    bool done() const
+    {
+      return lo >= hi;
+    }
+
+    /**
+     * The first sequence number from which operations need to be indexed.
+     * Only meaningful once done() returns true.
+     */
+    ccf::SeqNo result() const
+    {
+      return lo;
+    }
+
+    time_t get_cutoff() const
+    {
+      return cutoff;
+    }
+
+    /**
+     * The sequence number of the next transaction to look at.
+     */
+    ccf::SeqNo next_probe() const
+    {
+      return cursor;
+    }
+
+    /**
+     * The end of the interval in which the current probe looks for an
+     * operation, exclusive.
+     */
+    ccf::SeqNo probe_end() const
+    {
+      return hi;
+    }
+
+    /**
+     * Skip the transactions from next_probe() up to seqno, exclusive, which
+     * the caller knows don't record any operation. This is equivalent to
+     * recording std::nullopt for each of them.
+     */
+    void skip_to(ccf::SeqNo seqno)
+    {
+      if (done() || seqno <= cursor)
+      {
+        return;
+      }
+
+      cursor = seqno;
+      if (cursor >= hi)
+      {
+        // Nothing between mid and hi records an operation.
+        hi = mid;
+        start_probe();
+      }
+    }
+
+    /**
+     * Record the creation time of the operation recorded by a transaction, or
+     * std::nullopt if it doesn't record a new operation. Transactions other
+     * than the one returned by next_probe() are ignored.
+     */
+    void record(ccf::SeqNo seqno, std::optional<time_t> created_at)
+    {
+      if (done() || seqno != cursor)
+      {
+        return;
+      }
+
+      if (created_at.has_value())
+      {
+        if (created_at.value() >= cutoff)
+        {
+          hi = mid;
+        }
+        else
+        {
+          lo = cursor + 1;
+        }
+        start_probe();
+      }
+      else
+      {
+        skip_to(cursor + 1);
+      }
+    }
+
+  private:
+    ccf::SeqNo lo;
+    ccf::SeqNo hi;
+    const time_t cutoff;
+
+    ccf::SeqNo mid = 0;
+    ccf::SeqNo cursor = 0;
+
+    void start_probe()
+    {
+      mid = lo + (hi - lo) / 2;
+      cursor = mid;
+    }
+  };
+}
@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+
+#include <ccf/tx_id.h>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace scitt::indexing
+{
+  /**
+   * Requests waiting for an operation to leave the "running" state, keyed by
+   * the sequence number of the operation.
+   *
+   * The indexing strategy completes waiters as it indexes the transactions
+   * that they are waiting for, and expires them once their deadline has
+   * passed. Completed waiters are only queued, and their callbacks are run
+   * by whoever calls take_completed(), such that callbacks never run while
+   * the strategy's own lock is held.
+   *
+   * The number of waiters is bounded, since each one holds on to a client
+   * request.
+   */
+  class OperationWaiters
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    OperationWaiters(size_t max_waiters) : max_waiters(max_waiters) {}
+
+    /**
+     * Add a waiter for the operation at the given seqno. Returns false if
+     * there are too many waiters already, in which case the callback will
+     * never be called.
+     */
+    bool add(ccf::SeqNo seqno, Clock::time_point deadline, Callback callback)
+    {
+      std::lock_guard guard(lock);
+      if (waiters.size() >= max_waiters)
+      {
+        return false;
+      }
+      waiters.emplace(seqno, Waiter{deadline, std::move(callback)});
+      return true;
+    }
+
+    /**
+     * Complete the waiters for the operation at the given seqno.
+     */
+    void complete(ccf::SeqNo seqno)
+    {
+      std::lock_guard guard(lock);
+      complete_locked(waiters.lower_bound(seqno), waiters.upper_bound(seqno));
+    }
+
+    /**
+     * Complete the waiters for any operation in [from, to).
+     */
+    void complete_range(ccf::SeqNo from, ccf::SeqNo to)
+    {
+      if (from >= to)
+      {
+        return;
+      }
+      std::lock_guard guard(lock);
+      complete_locked(waiters.lower_bound(from), waiters.lower_bound(to));
+    }
+
+    /**
+     * Complete the waiters whose deadline has passed.
+     */
+    void complete_expired(Clock::time_point now = Clock::now())
+    {
+      std::lock_guard guard(lock);
+      for (auto it = waiters.begin(); it != waiters.end();)
+      {
+        if (it->second.deadline <= now)
+        {
+          completed.push_back(std::move(it->second.callback));
+          it = waiters.erase(it);
+        }
+        else
+        {
+          it++;
+        }
+      }
+    }
+
+    /**
+     * Return the callbacks of the waiters completed so far, for the caller
+     * to run.
+     */
+    std::vector<Callback> take_completed()
+    {
+      std::lock_guard guard(lock);
+      return std::exchange(completed, {});
+    }
+
+    /**
+     * Number of waiters which haven't completed yet.
+     */
+    size_t size() const
+    {
+      std::lock_guard guard(lock);
+      return waiters.size();
+    }
+
+  private:
+    struct Waiter
+    {
+      Clock::time_point deadline;
+      Callback callback;
+    };
+
+    using Waiters = std::multimap<ccf::SeqNo, Waiter>;
+
+    void complete_locked(Waiters::iterator begin, Waiters::iterator end)
+    {
+      for (auto it = begin; it != end; it++)
+      {
+        completed.push_back(std::move(it->second.callback));
+      }
+      waiters.erase(begin, end);
+    }
+
+    const size_t max_waiters;
+    Waiters waiters;
+    std::vector<Callback> completed;
+
+    mutable std::mutex lock;
+  };
+}
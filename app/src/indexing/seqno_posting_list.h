@@ -0,0 +1,250 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+
+#include <algorithm>
+#include <ccf/tx_id.h>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace scitt::indexing
+{
+  /**
+   * A compressed, append-only set of sequence numbers.
+   *
+   * Sequence numbers are grouped into runs of consecutive values. Each run is
+   * encoded as two LEB128 varints: the gap between the end of the previous run
+   * and the start of this one, followed by the length of the run minus one.
+   *
+   * On a ledger where nearly every transaction is an entry, runs are only
+   * broken up by signature and governance transactions, and a run of thousands
+   * of sequence numbers takes a handful of bytes. On a sparse ledger, each
+   * sequence number takes about as many bytes as its distance from the
+   * previous one needs, which is still much smaller than a tree node.
+   *
+   * The last run is kept decoded, so that appending consecutive sequence
+   * numbers only increments a counter.
+   *
+   * Every SKIP_INTERVAL runs, the offset of the next run is recorded in a
+   * skip table, along with the position its gap is measured from. Queries
+   * over a range start decoding from the last such run before it, rather
+   * than from the start of the list.
+   */
+  class SeqNoPostingList
+  {
+  public:
+    static constexpr size_t SKIP_INTERVAL = 64;
+
+    SeqNoPostingList(ccf::SeqNo base = 0) : base(base), encoded_end(base) {}
+
+    /**
+     * Add a sequence number to the list. Sequence numbers must be appended in
+     * strictly increasing order, and be no smaller than the list's base.
+     */
+    void append(ccf::SeqNo seqno)
+    {
+      if (run_length > 0 && seqno == run_start + run_length)
+      {
+        run_length++;
+      }
+      else
+      {
+        if (seqno < (run_length > 0 ? run_start + run_length : encoded_end))
+        {
+          throw std::logic_error(
+            "Sequence numbers must be appended in increasing order");
+        }
+        flush_run();
+        run_start = seqno;
+        run_length = 1;
+      }
+      count++;
+    }
+
+    /**
+     * Release any capacity reserved for future appends. This should be called
+     * once no more sequence numbers are expected to be added.
+     */
+    void shrink_to_fit()
+    {
+      encoded.shrink_to_fit();
+      skips.shrink_to_fit();
+    }
+
+    size_t size() const
+    {
+      return count;
+    }
+
+    bool empty() const
+    {
+      return count == 0;
+    }
+
+    /**
+     * Approximate number of bytes of memory used by the list.
+     */
+    size_t size_bytes() const
+    {
+      return sizeof(*this) + encoded.capacity() +
+        skips.capacity() * sizeof(Skip);
+    }
+
+    /**
+     * Call f(start, length) for every run of consecutive sequence numbers, in
+     * increasing order. Runs which end before from may be skipped. Iteration
+     * stops early if f returns false.
+     */
+    template <typename F>
+    void for_each_run(ccf::SeqNo from, F&& f) const
+    {
+      size_t offset = 0;
+      ccf::SeqNo position = base;
+
+      // Skip to the last recorded run which starts after a position no
+      // greater than from. Every run before it ends before from.
+      auto skip = std::upper_bound(
+        skips.begin(), skips.end(), from, [](ccf::SeqNo seqno, const Skip& s) {
+          return seqno < s.position;
+        });
+      if (skip != skips.begin())
+      {
+        skip--;
+        offset = skip->offset;
+        position = skip->position;
+      }
+
+      while (offset < encoded.size())
+      {
+        const auto start = position + read_varint(offset);
+        const auto length = read_varint(offset) + 1;
+        if (!f(start, length))
+        {
+          return;
+        }
+        position = start + length;
+      }
+
+      if (run_length > 0)
+      {
+        f(run_start, run_length);
+      }
+    }
+
+    /**
+     * Count the sequence numbers in the inclusive range [from, to].
+     */
+    size_t count_in_range(ccf::SeqNo from, ccf::SeqNo to) const
+    {
+      size_t result = 0;
+      for_each_run(from, [&](ccf::SeqNo start, size_t length) {
+        if (start > to)
+        {
+          return false;
+        }
+        const auto lo = std::max(start, from);
+        const auto hi = std::min(start + length - 1, to);
+        if (lo <= hi)
+        {
+          result += hi - lo + 1;
+        }
+        return true;
+      });
+      return result;
+    }
+
+    /**
+     * Call f(seqno) for every sequence number in the inclusive range
+     * [from, to], in increasing order.
+     */
+    template <typename F>
+    void for_each_in_range(ccf::SeqNo from, ccf::SeqNo to, F&& f) const
+    {
+      for_each_run(from, [&](ccf::SeqNo start, size_t length) {
+        if (start > to)
+        {
+          return false;
+        }
+        const auto lo = std::max(start, from);
+        const auto hi = std::min(start + length - 1, to);
+        if (lo <= hi)
+        {
+          for (auto seqno = lo; seqno <= hi; seqno++)
+          {
+            f(seqno);
+          }
+        }
+        return true;
+      });
+    }
+
+  private:
+    // Sequence number from which the first gap is measured.
+    ccf::SeqNo base;
+
+    // Completed runs, varint-encoded as described above.
+    std::vector<uint8_t> encoded;
+
+    // One past the last sequence number of the last encoded run.
+    ccf::SeqNo encoded_end;
+
+    // Offset of every SKIP_INTERVAL-th encoded run, and the position its gap
+    // is measured from, ie. the encoded_end before it was written.
+    struct Skip
+    {
+      size_t offset;
+      ccf::SeqNo position;
+    };
+    std::vector<Skip> skips;
+    size_t encoded_runs = 0;
+
+    // The run currently being appended to, which is not encoded yet.
+    ccf::SeqNo run_start = 0;
+    size_t run_length = 0;
+
+    size_t count = 0;
+
+    void flush_run()
+    {
+      if (run_length == 0)
+      {
+        return;
+      }
+      if (encoded_runs % SKIP_INTERVAL == 0)
+      {
+        skips.push_back({encoded.size(), encoded_end});
+      }
+      encoded_runs++;
+      write_varint(run_start - encoded_end);
+      write_varint(run_length - 1);
+      encoded_end = run_start + run_length;
+      run_length = 0;
+    }
+
+    void write_varint(uint64_t value)
+    {
+      while (value >= 0x80)
+      {
+        encoded.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+      }
+      encoded.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint64_t read_varint(size_t& offset) const
+    {
+      uint64_t value = 0;
+      unsigned shift = 0;
+      uint8_t byte = 0;
+      do
+      {
+        byte = encoded.at(offset++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        shift += 7;
+      } while ((byte & 0x80) != 0);
+      return value;
+    }
+  };
+}
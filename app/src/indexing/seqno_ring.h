@@ -0,0 +1,177 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+#pragma once
+
+#include <algorithm>
+#include <ccf/tx_id.h>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace scitt::indexing
+{
+  /**
+   * A sorted collection of values keyed by sequence number, for keys which
+   * are inserted in increasing order and removed from the front.
+   *
+   * Entries are stored contiguously in a circular buffer, whose capacity is a
+   * power of two. Lookups are a binary search, insertion at the back and
+   * removal from the front are amortized O(1), and no allocation happens per
+   * entry. The buffer grows and shrinks by factors of two as entries are
+   * added and removed.
+   */
+  template <typename V>
+  class SeqNoRing
+  {
+  public:
+    struct Entry
+    {
+      ccf::SeqNo seqno = 0;
+      V value = {};
+    };
+
+    size_t size() const
+    {
+      return count;
+    }
+
+    bool empty() const
+    {
+      return count == 0;
+    }
+
+    /**
+     * Approximate number of bytes of memory used by the ring.
+     */
+    size_t size_bytes() const
+    {
+      return sizeof(*this) + buffer.capacity() * sizeof(Entry);
+    }
+
+    /**
+     * Add a value at the back. Its sequence number must be greater than that
+     * of every entry already in the ring.
+     */
+    V& push_back(ccf::SeqNo seqno, V value)
+    {
+      if (count > 0 && seqno <= back().seqno)
+      {
+        throw std::logic_error(
+          "Sequence numbers must be inserted in increasing order");
+      }
+      if (count == buffer.size())
+      {
+        resize(std::max(MIN_CAPACITY, buffer.size() * 2));
+      }
+
+      auto& entry = at(count++);
+      entry.seqno = seqno;
+      entry.value = std::move(value);
+      return entry.value;
+    }
+
+    /**
+     * Remove the entry at the front, which has the smallest sequence number.
+     */
+    void pop_front()
+    {
+      if (count == 0)
+      {
+        throw std::logic_error("Cannot pop from an empty ring");
+      }
+
+      buffer[head] = {};
+      head = (head + 1) & (buffer.size() - 1);
+      count--;
+
+      if (buffer.size() > MIN_CAPACITY && count * 4 <= buffer.size())
+      {
+        resize(buffer.size() / 2);
+      }
+    }
+
+    const Entry& front() const
+    {
+      return at(0);
+    }
+
+    const Entry& back() const
+    {
+      return at(count - 1);
+    }
+
+    /**
+     * Get the i-th entry, counting from the front.
+     */
+    const Entry& operator[](size_t i) const
+    {
+      return at(i);
+    }
+
+    V* find(ccf::SeqNo seqno)
+    {
+      auto i = lower_bound(seqno);
+      if (i < count && at(i).seqno == seqno)
+      {
+        return &at(i).value;
+      }
+      return nullptr;
+    }
+
+    const V* find(ccf::SeqNo seqno) const
+    {
+      return const_cast<SeqNoRing*>(this)->find(seqno);
+    }
+
+    /**
+     * Index of the first entry whose sequence number is not less than seqno,
+     * or size() if there is none.
+     */
+    size_t lower_bound(ccf::SeqNo seqno) const
+    {
+      size_t lo = 0;
+      size_t hi = count;
+      while (lo < hi)
+      {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (at(mid).seqno < seqno)
+        {
+          lo = mid + 1;
+        }
+        else
+        {
+          hi = mid;
+        }
+      }
+      return lo;
+    }
+
+  private:
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    std::vector<Entry> buffer;
+    size_t head = 0;
+    size_t count = 0;
+
+    Entry& at(size_t i)
+    {
+      return buffer[(head + i) & (buffer.size() - 1)];
+    }
+
+    const Entry& at(size_t i) const
+    {
+      return buffer[(head + i) & (buffer.size() - 1)];
+    }
+
+    void resize(size_t capacity)
+    {
+      std::vector<Entry> resized(capacity);
+      for (size_t i = 0; i < count; i++)
+      {
+        resized[i] = std::move(at(i));
+      }
+      buffer = std::move(resized);
+      head = 0;
+    }
+  };
+}
@@ -0,0 +1,227 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace scitt
+{
+  /**
+   * Cost of verifying the signed statements of an issuer.
+   */
+  struct IssuerCost
+  {
+    std::string issuer;
+    uint64_t count = 0;
+    uint64_t cpu_us = 0;
+    uint64_t bytes = 0;
+
+    /**
+     * Upper bound on how much cpu_us overestimates the cost of this issuer.
+     * The count and bytes inherited from evicted issuers are overestimated
+     * likewise. See HeavyHitters.
+     */
+    uint64_t error_us = 0;
+  };
+
+  /**
+   * A Space-Saving sketch of the issuers with the largest CPU cost.
+   *
+   * At most `capacity` issuers are tracked. When a new issuer is seen and the
+   * sketch is full, it replaces the tracked issuer with the smallest cost and
+   * inherits its counters. Any issuer whose true cost exceeds 1/capacity of
+   * the total is guaranteed to be tracked, and the cost of a tracked issuer
+   * is overestimated by at most its error_us.
+   */
+  class HeavyHitters
+  {
+  public:
+    explicit HeavyHitters(size_t capacity) : capacity(capacity) {}
+
+    void add(const std::string& issuer, uint64_t cpu_us, uint64_t bytes)
+    {
+      auto it = entries.find(issuer);
+      if (it == entries.end())
+      {
+        if (entries.size() < capacity)
+        {
+          it = entries.emplace(issuer, IssuerCost{.issuer = issuer}).first;
+        }
+        else
+        {
+          // The sketch is small, so a linear scan for the minimum is cheaper
+          // than maintaining an ordered index on every update.
+          auto min = std::min_element(
+            entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+              return a.second.cpu_us < b.second.cpu_us;
+            });
+          auto evicted = std::move(min->second);
+          entries.erase(min);
+
+          evicted.issuer = issuer;
+          evicted.error_us = evicted.cpu_us;
+          it = entries.emplace(issuer, std::move(evicted)).first;
+        }
+      }
+
+      it->second.count++;
+      it->second.cpu_us += cpu_us;
+      it->second.bytes += bytes;
+    }
+
+    const std::unordered_map<std::string, IssuerCost>& get_entries() const
+    {
+      return entries;
+    }
+
+    void clear()
+    {
+      entries.clear();
+    }
+
+  private:
+    size_t capacity;
+    std::unordered_map<std::string, IssuerCost> entries;
+  };
+
+  /**
+   * Heavy hitters over a sliding window of recent time.
+   *
+   * Time is split into fixed windows, each with its own sketch, and the most
+   * recent WINDOW_COUNT windows are kept. A report merges the sketches of the
+   * windows it covers, so memory stays bounded regardless of the number of
+   * distinct issuers.
+   */
+  class IssuerCostTracker
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr auto WINDOW_DURATION = std::chrono::minutes(1);
+    static constexpr size_t WINDOW_COUNT = 60;
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    // Issuers are chosen by clients, so they are truncated to bound the
+    // memory used by the sketches.
+    static constexpr size_t MAX_ISSUER_LENGTH = 256;
+
+    explicit IssuerCostTracker(size_t capacity = DEFAULT_CAPACITY)
+    {
+      windows.reserve(WINDOW_COUNT);
+      for (size_t i = 0; i < WINDOW_COUNT; i++)
+      {
+        windows.push_back({-1, HeavyHitters(capacity)});
+      }
+    }
+
+    void record(
+      std::string_view issuer,
+      Clock::duration cpu,
+      uint64_t bytes,
+      Clock::time_point now = Clock::now())
+    {
+      auto cpu_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(cpu).count();
+      auto index = window_index(now);
+
+      std::lock_guard guard(lock);
+      auto& window = windows[static_cast<size_t>(index) % WINDOW_COUNT];
+      if (window.index != index)
+      {
+        window.index = index;
+        window.sketch.clear();
+      }
+      window.sketch.add(
+        std::string(issuer.substr(0, MAX_ISSUER_LENGTH)),
+        cpu_us < 0 ? 0 : cpu_us,
+        bytes);
+    }
+
+    /**
+     * Get the n issuers with the largest CPU cost over the last
+     * `window_count` windows, including the current one, most expensive
+     * first.
+     */
+    std::vector<IssuerCost> top(
+      size_t n, size_t window_count, Clock::time_point now = Clock::now()) const
+    {
+      auto index = window_index(now);
+      window_count = std::min(window_count, WINDOW_COUNT);
+
+      std::unordered_map<std::string, IssuerCost> merged;
+      {
+        std::lock_guard guard(lock);
+        for (size_t i = 0; i < window_count; i++)
+        {
+          const auto target = index - static_cast<int64_t>(i);
+          if (target < 0)
+          {
+            break;
+          }
+          const auto& window =
+            windows[static_cast<size_t>(target) % WINDOW_COUNT];
+          if (window.index != target)
+          {
+            continue;
+          }
+          for (const auto& [issuer, cost] : window.sketch.get_entries())
+          {
+            auto& total = merged[issuer];
+            total.issuer = issuer;
+            total.count += cost.count;
+            total.cpu_us += cost.cpu_us;
+            total.bytes += cost.bytes;
+            total.error_us += cost.error_us;
+          }
+        }
+      }
+
+      std::vector<IssuerCost> out;
+      out.reserve(merged.size());
+      for (auto& [issuer, cost] : merged)
+      {
+        out.push_back(std::move(cost));
+      }
+      std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+        return a.cpu_us > b.cpu_us;
+      });
+      if (out.size() > n)
+      {
+        out.resize(n);
+      }
+      return out;
+    }
+
+  private:
+    struct Window
+    {
+      int64_t index;
+      HeavyHitters sketch;
+    };
+
+    mutable std::mutex lock;
+    std::vector<Window> windows;
+
+    static int64_t window_index(Clock::time_point now)
+    {
+      return now.time_since_epoch() / WINDOW_DURATION;
+    }
+  };
+
+  /**
+   * Verification costs of the issuers seen by this node.
+   */
+  inline IssuerCostTracker& issuer_costs()
+  {
+    static IssuerCostTracker instance;
+    return instance;
+  }
+}
@@ -5,6 +5,8 @@
 #include "did/document.h"
 #include "odata_error.h"
 #include "policy_engine.h"
+#include "policy_rules.h"
+#include "rate_limiter.h"
 #include "signature_algorithms.h"
 
 #include <ccf/crypto/hash_provider.h>
@@ -74,6 +76,20 @@ namespace scitt
      */
     struct Policy
     {
+      /**
+       * A policy applied to the signed statements whose CWT issuer starts
+       * with a given prefix, instead of the policy script and rules of the
+       * enclosing policy object.
+       */
+      struct Route
+      {
+        std::string issuer_prefix;
+        std::optional<PolicyScript> policy_script;
+        std::optional<std::vector<PolicyRule>> policy_rules;
+
+        bool operator==(const Route& other) const = default;
+      };
+
       /**
        * List of accepted COSE signature algorithms when verifying signatures.
        * The names are case sensitive.
@@ -87,6 +103,49 @@ namespace scitt
        */
       std::optional<PolicyScript> policy_script;
 
+      /**
+       * Number of policy script verdicts cached by each node. Setting it
+       * declares that the policy script only depends on the headers and
+       * attestation details of a signed statement, and not on its payload or
+       * on the current time. Verdicts are not cached if unset or zero.
+       */
+      std::optional<size_t> policy_verdict_cache_size;
+
+      /**
+       * Policies routed by issuer. Each signed statement is only checked
+       * against the route with the longest matching issuer prefix, or against
+       * the policy script and rules of this object if no route matches.
+       */
+      std::optional<std::vector<Route>> policy_routes;
+
+      /**
+       * Declarative rules applied to each incoming entry, all of which must
+       * be met. They are compiled to native code rather than run by a JS
+       * interpreter, and are checked before the policy script if both are
+       * set.
+       */
+      std::optional<std::vector<PolicyRule>> policy_rules;
+
+      // The following limits are checked as soon as the headers of a signed
+      // statement are decoded, before any cryptographic verification, so
+      // that disallowed signed statements are cheaply rejected.
+
+      /**
+       * Prefixes of the CWT issuers whose signed statements are accepted.
+       * Any issuer is accepted if unset.
+       */
+      std::optional<std::vector<std::string>> accepted_issuer_prefixes;
+
+      /**
+       * Maximum number of certificates in an x5chain header.
+       */
+      std::optional<size_t> max_x5chain_length;
+
+      /**
+       * Maximum size of the encoded protected header, in bytes.
+       */
+      std::optional<size_t> max_protected_header_size;
+
       std::vector<std::string> get_accepted_algorithms() const
       {
         if (accepted_algorithms.has_value())
@@ -123,13 +182,49 @@ namespace scitt
       bool operator==(const Authentication& other) const = default;
     };
 
+    /**
+     * Limits on the rate at which signed statements are accepted for
+     * registration. Requests over a limit are rejected before any
+     * cryptographic verification takes place.
+     */
+    struct RateLimits
+    {
+      /**
+       * Limit per CWT issuer of the signed statement.
+       */
+      std::optional<RateLimit> per_issuer;
+
+      /**
+       * Limit per subject of the JWT used to authenticate the request.
+       */
+      std::optional<RateLimit> per_subject;
+
+      bool operator==(const RateLimits& other) const = default;
+    };
+
     Policy policy = {};
     Authentication authentication = {};
+    LogSettings logging = {};
+    RateLimits rate_limits = {};
 
     // deprecated
     std::optional<std::string> service_issuer;
   };
 
+  DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(PolicyRule);
+  DECLARE_JSON_REQUIRED_FIELDS(PolicyRule, field, op, value);
+  DECLARE_JSON_OPTIONAL_FIELDS(PolicyRule, reason);
+
+  DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(Configuration::Policy::Route);
+  DECLARE_JSON_REQUIRED_FIELDS_WITH_RENAMES(
+    Configuration::Policy::Route, issuer_prefix, "issuerPrefix");
+  DECLARE_JSON_OPTIONAL_FIELDS_WITH_RENAMES(
+    Configuration::Policy::Route,
+    policy_script,
+    "policyScript",
+    policy_rules,
+    "policyRules");
+
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(Configuration::Policy);
   DECLARE_JSON_REQUIRED_FIELDS(Configuration::Policy);
   DECLARE_JSON_OPTIONAL_FIELDS_WITH_RENAMES(
@@ -137,7 +232,19 @@ namespace scitt
     accepted_algorithms,
     "acceptedAlgorithms",
     policy_script,
-    "policyScript");
+    "policyScript",
+    policy_rules,
+    "policyRules",
+    policy_verdict_cache_size,
+    "policyVerdictCacheSize",
+    policy_routes,
+    "policyRoutes",
+    accepted_issuer_prefixes,
+    "acceptedIssuerPrefixes",
+    max_x5chain_length,
+    "maxX5chainLength",
+    max_protected_header_size,
+    "maxProtectedHeaderBytes");
 
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(Configuration::Authentication::JWT);
   DECLARE_JSON_REQUIRED_FIELDS(Configuration::Authentication::JWT);
@@ -153,6 +260,31 @@ namespace scitt
     allow_unauthenticated,
     "allowUnauthenticated");
 
+  DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(LogSettings);
+  DECLARE_JSON_REQUIRED_FIELDS(LogSettings);
+  DECLARE_JSON_OPTIONAL_FIELDS_WITH_RENAMES(
+    LogSettings,
+    sampling,
+    "sampling",
+    compact,
+    "compact",
+    slow_request_threshold_ms,
+    "slowRequestThresholdMs");
+
+  DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(RateLimit);
+  DECLARE_JSON_REQUIRED_FIELDS_WITH_RENAMES(
+    RateLimit, rate_per_second, "ratePerSecond");
+  DECLARE_JSON_OPTIONAL_FIELDS(RateLimit, burst);
+
+  DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(Configuration::RateLimits);
+  DECLARE_JSON_REQUIRED_FIELDS(Configuration::RateLimits);
+  DECLARE_JSON_OPTIONAL_FIELDS_WITH_RENAMES(
+    Configuration::RateLimits,
+    per_issuer,
+    "perIssuer",
+    per_subject,
+    "perSubject");
+
   DECLARE_JSON_TYPE_WITH_OPTIONAL_FIELDS(Configuration);
   DECLARE_JSON_REQUIRED_FIELDS(Configuration);
   DECLARE_JSON_OPTIONAL_FIELDS_WITH_RENAMES(
@@ -161,6 +293,10 @@ namespace scitt
     "policy",
     authentication,
     "authentication",
+    logging,
+    "logging",
+    rate_limits,
+    "rateLimits",
     service_issuer,
     "serviceIssuer");
 
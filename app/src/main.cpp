@@ -3,15 +3,19 @@
 
 #include "call_types.h"
 #include "configurable_auth.h"
+#include "configuration_cache.h"
 #include "constants.h"
 #include "cose.h"
 #include "did/document.h"
 #include "generated/constants.h"
 #include "historical/historical_queries_adapter.h"
 #include "http_error.h"
+#include "indexing/entry_seqno_index.h"
 #include "kv_types.h"
 #include "operations_endpoints.h"
 #include "policy_engine.h"
+#include "policy_table.h"
+#include "policy_verdict_cache.h"
 #include "service_endpoints.h"
 #include "tracing.h"
 #include "util.h"
@@ -22,12 +26,12 @@
 #include <ccf/common_auth_policies.h>
 #include <ccf/crypto/base64.h>
 #include <ccf/crypto/cose.h>
+#include <ccf/crypto/sha256_hash.h>
 #include <ccf/ds/logger.h>
 #include <ccf/endpoint.h>
 #include <ccf/historical_queries_adapter.h>
 #include <ccf/historical_queries_interface.h>
 #include <ccf/http_query.h>
-#include <ccf/indexing/strategies/seqnos_by_key_bucketed.h>
 #include <ccf/json_handler.h>
 #include <ccf/kv/value.h>
 #include <ccf/node/host_processes_interface.h>
@@ -53,9 +57,6 @@ namespace scitt
 {
   using ccf::endpoints::EndpointContext;
 
-  using EntrySeqnoIndexingStrategy =
-    ccf::indexing::strategies::SeqnosForValue_Bucketed<EntryTable>;
-
   /**
    * This is a re-implementation of CCF's get_query_value, but it throws a
    * BadRequestJsonError if the query parameter cannot be parsed. Also supports
@@ -156,9 +157,135 @@ namespace scitt
   class AppEndpoints : public ccf::UserEndpointRegistry
   {
   private:
-    std::shared_ptr<EntrySeqnoIndexingStrategy> entry_seqno_index = nullptr;
+    std::shared_ptr<indexing::EntrySeqnoIndexingStrategy> entry_seqno_index =
+      nullptr;
     std::unique_ptr<verifier::Verifier> verifier = nullptr;
 
+    TokenBuckets issuer_buckets;
+    TokenBuckets subject_buckets;
+    metrics::Counter& statements_rate_limited = metrics::registry().counter(
+      "scitt_signed_statements_rejected_total",
+      "Number of signed statements rejected, by reason",
+      {{"reason", "rate_limit"}});
+
+    // The logging settings are needed by every request, and the policies by
+    // every registration, so they are only derived again when the
+    // configuration changes.
+    ConfigurationCache<LogSettings> log_settings{
+      [](const Configuration& cfg) { return cfg.logging; }};
+    ConfigurationCache<PolicyTable> policies{[](const Configuration& cfg) {
+      return PolicyTable::compile(cfg.policy);
+    }};
+
+    PolicyVerdictCache policy_verdicts;
+
+    std::shared_ptr<const PolicyTable> get_policies(ccf::kv::ReadOnlyTx& tx)
+    {
+      try
+      {
+        return policies.get(tx);
+      }
+      catch (const std::invalid_argument& e)
+      {
+        throw BadRequestCborError(
+          errors::PolicyError,
+          fmt::format("Invalid policy rules: {}", e.what()));
+      }
+    }
+
+    /**
+     * Take a token from the bucket of the given key, or reject the request if
+     * there is none left.
+     */
+    void check_rate_limit(
+      TokenBuckets& buckets,
+      const std::string& kind,
+      const std::string& key,
+      const RateLimit& limit)
+    {
+      // Keys are chosen by clients, so only their digest is kept, and they
+      // are not repeated back in the error.
+      auto wait =
+        buckets.try_acquire(ccf::crypto::Sha256Hash(key).hex_str(), limit);
+      if (wait.has_value())
+      {
+        statements_rate_limited.increment();
+        auto retry_after = retry_after_seconds(wait.value());
+        throw TooManyRequestsCborError(
+          errors::TooManyRequests,
+          fmt::format(
+            "Rate limit exceeded for {}, retry after {} seconds",
+            kind,
+            retry_after),
+          retry_after);
+      }
+    }
+
+    /**
+     * Reject a registration which exceeds the configured rate limit of the
+     * subject of the JWT the request was authenticated with. This must be
+     * cheap, since it is meant to protect the service from spending time
+     * verifying signed statements on behalf of a single caller.
+     */
+    void check_subject_rate_limit(
+      EndpointContext& ctx, const Configuration::RateLimits& limits)
+    {
+      if (!limits.per_subject.has_value())
+      {
+        return;
+      }
+      const auto* jwt = ctx.try_get_caller<ccf::JwtAuthnIdentity>();
+      if (jwt == nullptr)
+      {
+        return;
+      }
+      auto sub = jwt->payload.find("sub");
+      if (sub != jwt->payload.end() && sub->is_string())
+      {
+        check_rate_limit(
+          subject_buckets,
+          "subject",
+          sub->get<std::string>(),
+          limits.per_subject.value());
+      }
+    }
+
+    /**
+     * Reject a registration which exceeds the configured rate limit of its
+     * issuer. This is only checked once the signed statement is verified,
+     * since anyone can claim to be an issuer and use up its limit otherwise.
+     */
+    void check_issuer_rate_limit(
+      const cose::ProtectedHeader& phdr,
+      const Configuration::RateLimits& limits)
+    {
+      if (limits.per_issuer.has_value() && phdr.cwt_claims.iss.has_value())
+      {
+        check_rate_limit(
+          issuer_buckets,
+          "issuer",
+          phdr.cwt_claims.iss.value(),
+          limits.per_issuer.value());
+      }
+    }
+
+    /**
+     * Reject a query over a range that the entry index hasn't caught up with
+     * yet, telling the client how long it is expected to take.
+     */
+    [[noreturn]] void throw_indexing_in_progress(ccf::SeqNo target)
+    {
+      const auto indexed = entry_seqno_index->get_indexed_watermark().seqno;
+      throw ServiceUnavailableJsonError(
+        errors::IndexingInProgressRetryLater,
+        fmt::format(
+          "Index of requested range not available yet (indexed up to {} of "
+          "{}), retry later",
+          indexed,
+          target),
+        entry_seqno_index->get_retry_after_seconds(target));
+    }
+
     std::optional<ccf::TxStatus> get_tx_status(ccf::SeqNo seqno)
     {
       SCITT_DEBUG("Get transaction status");
@@ -181,6 +308,73 @@ namespace scitt
       return std::nullopt;
     }
 
+    /**
+     * Parse the "from" and "to" query parameters of a request over a range of
+     * entries, and check that the range is valid and has been committed. If
+     * "to" is missing, the range ends at the last committed transaction.
+     */
+    std::pair<ccf::SeqNo, ccf::SeqNo> get_committed_seqno_range(
+      EndpointContext& ctx)
+    {
+      const auto parsed_query =
+        ccf::http::parse_query(ctx.rpc_ctx->get_request_query());
+
+      SCITT_DEBUG("Parse input params and determine entries range");
+      ccf::SeqNo from_seqno =
+        get_query_value<uint64_t>(parsed_query, "from").value_or(1);
+      std::optional<ccf::SeqNo> to_seqno_opt =
+        get_query_value<uint64_t>(parsed_query, "to");
+      ccf::SeqNo to_seqno;
+
+      if (to_seqno_opt.has_value())
+      {
+        to_seqno = *to_seqno_opt;
+      }
+      else
+      {
+        ccf::View view;
+        ccf::SeqNo seqno;
+        const auto result = get_last_committed_txid_v1(view, seqno);
+        if (result != ccf::ApiResult::OK)
+        {
+          throw InternalJsonError(fmt::format(
+            "Failed to get last committed transaction ID: {}",
+            ccf::api_result_to_str(result)));
+        }
+        to_seqno = seqno;
+      }
+
+      if (to_seqno < from_seqno)
+      {
+        throw BadRequestJsonError(
+          errors::InvalidInput,
+          fmt::format(
+            "Invalid range: Starts at {} but ends at {}",
+            from_seqno,
+            to_seqno));
+      }
+
+      const auto tx_status = get_tx_status(to_seqno);
+      if (!tx_status.has_value())
+      {
+        throw InternalJsonError(fmt::format(
+          "Failed to get transaction status for seqno {}", to_seqno));
+      }
+
+      if (tx_status.value() != ccf::TxStatus::Committed)
+      {
+        throw BadRequestJsonError(
+          errors::InvalidInput,
+          fmt::format(
+            "Only committed transactions can be queried. Transaction at "
+            "seqno {} is {}",
+            to_seqno,
+            ccf::tx_status_to_str(tx_status.value())));
+      }
+
+      return {from_seqno, to_seqno};
+    }
+
     /**
      * Create an endpoint with a default locally committed handler.
      */
@@ -211,10 +405,15 @@ namespace scitt
           return this->get_untrusted_host_time_v1(time);
         };
 
+      const GetLogSettings get_log_settings = [this](ccf::kv::ReadOnlyTx& tx) {
+        return this->log_settings.get(tx);
+      };
+
       auto endpoint = ccf::UserEndpointRegistry::make_endpoint(
         method,
         verb,
-        tracing_adapter_first(error_adapter(f), method, get_time),
+        tracing_adapter_first(
+          error_adapter(f), method, get_time, get_log_settings),
         ap);
       endpoint.locally_committed_func =
         tracing_adapter_last(l, method, get_time);
@@ -227,26 +426,54 @@ namespace scitt
     {
       const ccf::AuthnPolicies authn_policy = {
         std::make_shared<ConfigurableEmptyAuthnPolicy>(),
-        std::make_shared<ConfigurableJwtAuthnPolicy>(),
+        std::make_shared<ConfigurableJwtAuthnPolicy>([this](timespec& time) {
+          return this->get_untrusted_host_time_v1(time);
+        }),
+      };
+
+      // Diagnostics describe other users' requests, and are only available to
+      // the members operating the service.
+      const ccf::AuthnPolicies member_authn_policy = {
+        ccf::member_cose_sign1_auth_policy,
       };
 
       SCITT_DEBUG("Get historical state from CCF");
       auto& state_cache = context.get_historical_state();
 
       SCITT_DEBUG("Install custom indexing strategy");
-      entry_seqno_index = std::make_shared<EntrySeqnoIndexingStrategy>(
-        ENTRY_TABLE,
-        context,
-        indexing::SEQNOS_PER_BUCKET,
-        indexing::MAX_BUCKETS);
+      entry_seqno_index =
+        std::make_shared<indexing::EntrySeqnoIndexingStrategy>(
+          state_cache,
+          indexing::SEQNOS_PER_BUCKET,
+          indexing::MAX_RESIDENT_BYTES);
       context.get_indexing_strategies().install_strategy(entry_seqno_index);
 
       verifier = std::make_unique<verifier::Verifier>();
 
-      auto register_signed_statement = [this](EndpointContext& ctx) {
+      auto* registered_statements = &metrics::registry().counter(
+        "scitt_signed_statements_registered_total",
+        "Number of signed statements accepted for registration");
+      auto* statements_failing_verification = &metrics::registry().counter(
+        "scitt_signed_statements_rejected_total",
+        "Number of signed statements rejected, by reason",
+        {{"reason", "verification"}});
+      auto* statements_failing_policy = &metrics::registry().counter(
+        "scitt_signed_statements_rejected_total",
+        "Number of signed statements rejected, by reason",
+        {{"reason", "policy"}});
+      auto* statement_size = &metrics::registry().histogram(
+        "scitt_signed_statement_size_bytes",
+        "Size of submitted signed statements");
+
+      auto register_signed_statement = [this,
+                                        registered_statements,
+                                        statements_failing_verification,
+                                        statements_failing_policy,
+                                        statement_size](EndpointContext& ctx) {
         const auto& body = ctx.rpc_ctx->get_request_body();
         SCITT_DEBUG(
           "Signed Statement Registration body size: {} bytes", body.size());
+        statement_size->record(static_cast<uint64_t>(body.size()));
         if (body.size() > MAX_ENTRY_SIZE_BYTES)
         {
           throw BadRequestCborError(
@@ -276,29 +503,83 @@ namespace scitt
         std::optional<verifier::VerifiedSevSnpAttestationDetails> details;
         try
         {
+          SCITT_DEBUG("Decode submitted signed statement");
+          std::tie(phdr, uhdr) =
+            verifier::Verifier::decode_signed_statement(body);
+
+          check_subject_rate_limit(ctx, cfg.rate_limits);
+
           SCITT_DEBUG("Verify submitted signed statement");
           std::tie(phdr, uhdr, payload, details) =
-            verifier->verify_signed_statement(body, ctx.tx, host_time, cfg);
+            verifier->verify_signed_statement(
+              body, phdr, uhdr, ctx.tx, host_time, cfg);
         }
         catch (const verifier::VerificationError& e)
         {
           SCITT_DEBUG("Signed statement verification failed: {}", e.what());
+          statements_failing_verification->increment();
           throw BadRequestCborError(errors::InvalidInput, e.what());
         }
 
-        if (cfg.policy.policy_script.has_value())
+        check_issuer_rate_limit(phdr, cfg.rate_limits);
+
+        // Verification only succeeds for a DID issuer, such as
+        // did:x509:0:..., whose method is recorded for slow requests.
+        const auto& issuer = phdr.cwt_claims.iss.value();
+        get_app_data(ctx.rpc_ctx).issuer_type =
+          issuer.substr(0, issuer.find(':', std::string_view("did:").size()));
+
+        // Remove un-authenticated content from payload, and only keep the
+        // actual signed statement, i.e. the bytes that are in fact signed.
+        // This makes a copy of the request body before the policy runs, since
+        // the policy is given the payload within the request body and could
+        // write to it. Nothing but the policy reads the payload afterwards.
+        const auto signed_statement = ccf::cose::edit::set_unprotected_header(
+          body, ccf::cose::edit::desc::Empty{});
+
+        // Keeps the selected policy alive, even if another request replaces
+        // the cached table.
+        const auto policy_table = get_policies(ctx.tx);
+        const auto& policy = policy_table->select(phdr.cwt_claims.iss);
+
+        if (!policy.empty())
         {
-          const auto policy_violation_reason = check_for_policy_violations(
-            cfg.policy.policy_script.value(),
-            "configured_policy",
-            phdr,
-            uhdr,
-            payload,
-            details);
+          std::optional<std::string> policy_violation_reason;
+          {
+            timing::ScopedStageTimer timer(timing::Stage::Policy);
+            // Rules are cheaper to evaluate, so they are checked first.
+            if (policy.rules.has_value())
+            {
+              policy_violation_reason =
+                check_for_rule_violations(policy.rules.value(), phdr, details);
+            }
+            if (
+              !policy_violation_reason.has_value() && policy.script.has_value())
+            {
+              PolicyVerdictCache* verdict_cache = nullptr;
+              if (cfg.policy.policy_verdict_cache_size.value_or(0) > 0)
+              {
+                policy_verdicts.configure(
+                  ctx.tx.template ro<ConfigurationTable>(CONFIGURATION_TABLE)
+                    ->get_version_of_previous_write(),
+                  cfg.policy.policy_verdict_cache_size.value());
+                verdict_cache = &policy_verdicts;
+              }
+              policy_violation_reason = check_for_policy_violations(
+                policy.script.value(),
+                policy.name,
+                phdr,
+                uhdr,
+                payload,
+                details,
+                verdict_cache);
+            }
+          }
           if (policy_violation_reason.has_value())
           {
             SCITT_DEBUG(
               "Policy check failed: {}", policy_violation_reason.value());
+            statements_failing_policy->increment();
             throw BadRequestCborError(
               errors::PolicyFailed,
               fmt::format(
@@ -311,6 +592,7 @@ namespace scitt
           if (verifier::contains_cwt_issuer(phdr))
           {
             SCITT_DEBUG("No policy applied, but CWT issuer present");
+            statements_failing_policy->increment();
             throw BadRequestCborError(
               errors::PolicyFailed,
               "Policy was not met: CWT issuer present but no policy "
@@ -322,10 +604,7 @@ namespace scitt
           }
         }
 
-        // Remove un-authenticated content from payload, and only keep the
-        // actual signed statement, i.e. the bytes that are in fact signed.
-        const auto signed_statement = ccf::cose::edit::set_unprotected_header(
-          body, ccf::cose::edit::desc::Empty{});
+        timing::ScopedStageTimer kv_timer(timing::Stage::Kv);
 
         // Bind the digest of the signed statement in the Merkle Tree as a
         // claims digest for this transaction
@@ -343,7 +622,9 @@ namespace scitt
 
         SCITT_DEBUG("SignedStatement was submitted synchronously");
 
-        record_synchronous_operation(host_time, ctx.tx);
+        record_synchronous_operation(
+          host_time, ctx.tx, get_app_data(ctx.rpc_ctx));
+        registered_statements->increment();
       };
 
       /**
@@ -466,84 +747,26 @@ namespace scitt
         [this](EndpointContext& ctx, nlohmann::json&& params) {
           std::ignore = params;
 
-          const auto parsed_query =
-            ccf::http::parse_query(ctx.rpc_ctx->get_request_query());
-
-          SCITT_DEBUG("Parse input params and determine entries range");
-          ccf::SeqNo from_seqno =
-            get_query_value<uint64_t>(parsed_query, "from").value_or(1);
-          std::optional<ccf::SeqNo> to_seqno_opt =
-            get_query_value<uint64_t>(parsed_query, "to");
-          ccf::SeqNo to_seqno;
-
-          if (to_seqno_opt.has_value())
-          {
-            to_seqno = *to_seqno_opt;
-          }
-          else
-          {
-            ccf::View view;
-            ccf::SeqNo seqno;
-            const auto result = get_last_committed_txid_v1(view, seqno);
-            if (result != ccf::ApiResult::OK)
-            {
-              throw InternalJsonError(fmt::format(
-                "Failed to get last committed transaction ID: {}",
-                ccf::api_result_to_str(result)));
-            }
-            to_seqno = seqno;
-          }
-
-          if (to_seqno < from_seqno)
-          {
-            throw BadRequestJsonError(
-              errors::InvalidInput,
-              fmt::format(
-                "Invalid range: Starts at {} but ends at {}",
-                from_seqno,
-                to_seqno));
-          }
-
-          const auto tx_status = get_tx_status(to_seqno);
-          if (!tx_status.has_value())
-          {
-            throw InternalJsonError(fmt::format(
-              "Failed to get transaction status for seqno {}", to_seqno));
-          }
-
-          if (tx_status.value() != ccf::TxStatus::Committed)
-          {
-            throw BadRequestJsonError(
-              errors::InvalidInput,
-              fmt::format(
-                "Only committed transactions can be queried. Transaction at "
-                "seqno {} is {}",
-                to_seqno,
-                ccf::tx_status_to_str(tx_status.value())));
-          }
-
-          const auto indexed_txid = entry_seqno_index->get_indexed_watermark();
-          if (indexed_txid.seqno < to_seqno)
-          {
-            throw ServiceUnavailableJsonError(
-              errors::IndexingInProgressRetryLater,
-              "Index of requested range not available yet, retry later",
-              1);
-          }
+          const auto [from_seqno, to_seqno] = get_committed_seqno_range(ctx);
 
           static constexpr size_t max_seqno_per_page = 10000;
           const auto range_begin = from_seqno;
           const auto range_end =
             std::min(to_seqno, range_begin + max_seqno_per_page);
 
+          // Only the current page needs to be indexed, so that clients
+          // enumerating the ledger can make progress while a node is still
+          // catching up with the end of it.
+          if (entry_seqno_index->get_indexed_watermark().seqno < range_end)
+          {
+            throw_indexing_in_progress(range_end);
+          }
+
           const auto interesting_seqnos =
             entry_seqno_index->get_write_txs_in_range(range_begin, range_end);
           if (!interesting_seqnos.has_value())
           {
-            throw ServiceUnavailableJsonError(
-              errors::IndexingInProgressRetryLater,
-              "Index of requested range not available yet, retry later",
-              1);
+            throw_indexing_in_progress(range_end);
           }
 
           SCITT_DEBUG("Get entries for the target range");
@@ -573,8 +796,7 @@ namespace scitt
             const auto next_page_start = range_end + 1;
             const auto next_range_end =
               std::min(to_seqno, next_page_start + max_seqno_per_page);
-            entry_seqno_index->get_write_txs_in_range(
-              next_page_start, next_range_end);
+            entry_seqno_index->prefetch_range(next_page_start, next_range_end);
             // NB: This path tells the caller to continue to ask until the end
             // of the range, even if the next response is paginated
             out.next_link = fmt::format(
@@ -601,6 +823,157 @@ namespace scitt
           "to", ccf::endpoints::QueryParamPresence::OptionalParameter)
         .install();
 
+      static constexpr auto get_entries_count_path = "/entries/count";
+      auto get_entries_count =
+        [this](EndpointContext& ctx, nlohmann::json&& params) {
+          std::ignore = params;
+
+          const auto [from_seqno, to_seqno] = get_committed_seqno_range(ctx);
+
+          if (entry_seqno_index->get_indexed_watermark().seqno < to_seqno)
+          {
+            throw_indexing_in_progress(to_seqno);
+          }
+
+          const auto count =
+            entry_seqno_index->count_write_txs_in_range(from_seqno, to_seqno);
+          if (!count.has_value())
+          {
+            throw_indexing_in_progress(to_seqno);
+          }
+
+          GetEntriesCount::Out out;
+          out.count = count.value();
+          return out;
+        };
+
+      /**
+       * This endpoint is not part of RFC, but lets clients find out how many
+       * entries were registered in a given range without enumerating them.
+       */
+      make_endpoint(
+        get_entries_count_path,
+        HTTP_GET,
+        ccf::json_adapter(get_entries_count),
+        authn_policy)
+        .set_auto_schema<void, GetEntriesCount::Out>()
+        .add_query_parameter<size_t>(
+          "from", ccf::endpoints::QueryParamPresence::OptionalParameter)
+        .add_query_parameter<size_t>(
+          "to", ccf::endpoints::QueryParamPresence::OptionalParameter)
+        .install();
+
+      metrics::registry().callback_gauge(
+        "scitt_index_watermark_seqno",
+        "Sequence number up to which each index has processed the ledger",
+        {{"index", "entries"}},
+        [index = entry_seqno_index] {
+          return index->get_indexed_watermark().seqno;
+        });
+      metrics::registry().callback_gauge(
+        "scitt_last_committed_seqno",
+        "Sequence number of the last committed transaction known to this node",
+        {},
+        [this] {
+          ccf::View view;
+          ccf::SeqNo seqno;
+          return this->get_last_committed_txid_v1(view, seqno) ==
+              ccf::ApiResult::OK ?
+            seqno :
+            0;
+        });
+
+      /**
+       * This endpoint is not part of the RFC. It exposes the metrics of the
+       * node serving the request, in the Prometheus text exposition format.
+       */
+      make_endpoint(
+        "/metrics",
+        HTTP_GET,
+        [](EndpointContext& ctx) {
+          auto body = metrics::registry().to_prometheus();
+          ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
+          ctx.rpc_ctx->set_response_header(
+            ccf::http::headers::CONTENT_TYPE,
+            "text/plain; version=0.0.4; charset=utf-8");
+          ctx.rpc_ctx->set_response_body(std::move(body));
+        },
+        authn_policy)
+        .set_forwarding_required(ccf::endpoints::ForwardingRequired::Never)
+        .install();
+
+      /**
+       * This endpoint is not part of the RFC. It returns the most recent
+       * requests to this node which exceeded the slow request threshold of
+       * the service configuration, with the time spent in each stage. Only
+       * members of the service may call it.
+       */
+      make_endpoint(
+        "/diagnostics/slowRequests",
+        HTTP_GET,
+        ccf::json_adapter([](EndpointContext& ctx, nlohmann::json&& params) {
+          std::ignore = ctx;
+          std::ignore = params;
+
+          GetSlowRequests::Out out;
+          // Read the requests first, so that the total is never less than
+          // their number.
+          out.requests = flight_recorder().get_recent();
+          out.total = flight_recorder().get_total();
+          return out;
+        }),
+        member_authn_policy)
+        .set_auto_schema<void, GetSlowRequests::Out>()
+        .set_forwarding_required(ccf::endpoints::ForwardingRequired::Never)
+        .install();
+
+      /**
+       * This endpoint is not part of the RFC. It lists the issuers whose
+       * signed statements took the most time to verify on this node, over
+       * the last few minutes. Only members of the service may call it.
+       */
+      make_endpoint(
+        "/diagnostics/issuers",
+        HTTP_GET,
+        ccf::json_adapter([](EndpointContext& ctx, nlohmann::json&& params) {
+          std::ignore = params;
+
+          const auto parsed_query =
+            ccf::http::parse_query(ctx.rpc_ctx->get_request_query());
+          const auto top =
+            get_query_value<size_t>(parsed_query, "top").value_or(10);
+          const auto minutes =
+            get_query_value<size_t>(parsed_query, "minutes").value_or(5);
+
+          const auto max_minutes =
+            IssuerCostTracker::WINDOW_COUNT *
+            IssuerCostTracker::WINDOW_DURATION / std::chrono::minutes(1);
+          if (minutes == 0 || minutes > max_minutes)
+          {
+            throw BadRequestJsonError(
+              errors::QueryParameterError,
+              fmt::format(
+                "Invalid value for query parameter 'minutes': must be between "
+                "1 and {}",
+                max_minutes));
+          }
+
+          GetIssuerCosts::Out out;
+          out.minutes = minutes;
+          out.issuers = issuer_costs().top(
+            top,
+            std::chrono::minutes(minutes) / IssuerCostTracker::WINDOW_DURATION);
+          return out;
+        }),
+        member_authn_policy)
+        .set_auto_schema<void, GetIssuerCosts::Out>()
+        .set_forwarding_required(ccf::endpoints::ForwardingRequired::Never)
+        .add_query_parameter<size_t>(
+          "top", ccf::endpoints::QueryParamPresence::OptionalParameter)
+        .add_query_parameter<size_t>(
+          "minutes", ccf::endpoints::QueryParamPresence::OptionalParameter)
+        .install();
+
       register_service_endpoints(context, *this);
 
       register_operations_endpoints(context, *this, authn_policy);
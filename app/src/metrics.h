@@ -0,0 +1,427 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fmt/format.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace scitt::metrics
+{
+  /**
+   * A monotonically increasing count of events.
+   */
+  class Counter
+  {
+  public:
+    void increment(uint64_t n = 1)
+    {
+      value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const
+    {
+      return value.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> value = 0;
+  };
+
+  /**
+   * A value which can go up and down, such as the size of a queue.
+   */
+  class Gauge
+  {
+  public:
+    void set(int64_t v)
+    {
+      value.store(v, std::memory_order_relaxed);
+    }
+
+    void add(int64_t n)
+    {
+      value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    int64_t get() const
+    {
+      return value.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<int64_t> value = 0;
+  };
+
+  /**
+   * A histogram of non-negative integer values, with exponentially sized
+   * buckets. Bucket 0 counts values under 2, and bucket i > 0 counts values
+   * in [2^i, 2^(i+1)). The last bucket also counts anything larger.
+   *
+   * Durations are recorded in microseconds. The relative error of any bucket
+   * is bounded, which is the property we need from latency distributions,
+   * without requiring any allocation or locking when recording.
+   */
+  class Histogram
+  {
+  public:
+    static constexpr size_t BUCKET_COUNT = 32;
+
+    static size_t bucket_index(uint64_t value)
+    {
+      if (value < 2)
+      {
+        return 0;
+      }
+      size_t i = std::bit_width(value) - 1;
+      return std::min(i, BUCKET_COUNT - 1);
+    }
+
+    static size_t bucket_index(std::chrono::steady_clock::duration duration)
+    {
+      return bucket_index(to_us(duration));
+    }
+
+    /**
+     * Inclusive upper bound of a bucket.
+     */
+    static uint64_t bucket_upper_bound(size_t i)
+    {
+      return (uint64_t{2} << i) - 1;
+    }
+
+    void record(uint64_t value)
+    {
+      buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+      count.fetch_add(1, std::memory_order_relaxed);
+      sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void record(std::chrono::steady_clock::duration duration)
+    {
+      record(to_us(duration));
+    }
+
+    uint64_t get_bucket(size_t i) const
+    {
+      return buckets[i].load(std::memory_order_relaxed);
+    }
+
+    uint64_t get_count() const
+    {
+      return count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t get_sum() const
+    {
+      return sum.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets = {};
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> sum = 0;
+
+    static uint64_t to_us(std::chrono::steady_clock::duration duration)
+    {
+      auto us =
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+      return us < 0 ? 0 : static_cast<uint64_t>(us);
+    }
+  };
+
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  // Scale applied to histograms of microseconds, which are exported in
+  // seconds as is conventional for Prometheus.
+  static constexpr double MICROSECONDS = 1e-6;
+
+  /**
+   * A set of named metrics, which can be exported in the Prometheus text
+   * exposition format.
+   *
+   * Metrics are registered once, typically when an endpoint is installed or
+   * the first time a code path runs, and the returned references are kept by
+   * the caller. Registration takes a lock, but updating a metric never does.
+   * Registering the same name and labels twice returns the same metric.
+   */
+  class Registry
+  {
+  public:
+    Counter& counter(
+      const std::string& name, const std::string& help, Labels labels = {})
+    {
+      return get_or_add<Counter>(name, help, "counter", std::move(labels));
+    }
+
+    Gauge& gauge(
+      const std::string& name, const std::string& help, Labels labels = {})
+    {
+      return get_or_add<Gauge>(name, help, "gauge", std::move(labels));
+    }
+
+    /**
+     * Register a histogram. Recorded values are multiplied by scale when
+     * exported, eg. MICROSECONDS for histograms of durations.
+     */
+    Histogram& histogram(
+      const std::string& name,
+      const std::string& help,
+      Labels labels = {},
+      double scale = 1)
+    {
+      return get_or_add<Histogram>(
+        name, help, "histogram", std::move(labels), scale);
+    }
+
+    /**
+     * Register a gauge whose value is computed when metrics are exported, for
+     * values which are already tracked elsewhere, such as the size of a
+     * cache. The callback must be thread-safe.
+     */
+    void callback_gauge(
+      const std::string& name,
+      const std::string& help,
+      Labels labels,
+      std::function<double()> callback)
+    {
+      std::lock_guard guard(lock);
+      auto& family = get_family(name, help, "gauge");
+      family.series.push_back(
+        {std::move(labels), 1, Callback{std::move(callback)}});
+    }
+
+    /**
+     * Render all metrics in the Prometheus text exposition format.
+     */
+    std::string to_prometheus() const
+    {
+      std::lock_guard guard(lock);
+
+      fmt::memory_buffer out;
+      auto it = std::back_inserter(out);
+      for (const auto& [name, family] : families)
+      {
+        fmt::format_to(it, "# HELP {} {}\n", name, family.help);
+        fmt::format_to(it, "# TYPE {} {}\n", name, family.type);
+        for (const auto& series : family.series)
+        {
+          render(it, name, series);
+        }
+      }
+      return fmt::to_string(out);
+    }
+
+  private:
+    struct Callback
+    {
+      std::function<double()> fn;
+    };
+
+    using Metric = std::variant<
+      const Counter*,
+      const Gauge*,
+      const Histogram*,
+      Callback>;
+
+    struct Series
+    {
+      Labels labels;
+      double scale;
+      Metric metric;
+    };
+
+    struct Family
+    {
+      std::string help;
+      std::string type;
+      std::vector<Series> series;
+    };
+
+    mutable std::mutex lock;
+    std::map<std::string, Family> families;
+
+    // Deques never move their elements, so references handed out remain
+    // valid as more metrics are registered.
+    std::deque<Counter> counters;
+    std::deque<Gauge> gauges;
+    std::deque<Histogram> histograms;
+
+    template <typename T>
+    std::deque<T>& storage()
+    {
+      if constexpr (std::is_same_v<T, Counter>)
+      {
+        return counters;
+      }
+      else if constexpr (std::is_same_v<T, Gauge>)
+      {
+        return gauges;
+      }
+      else
+      {
+        return histograms;
+      }
+    }
+
+    Family& get_family(
+      const std::string& name, const std::string& help, const char* type)
+    {
+      auto [it, inserted] = families.try_emplace(name);
+      if (inserted)
+      {
+        it->second.help = help;
+        it->second.type = type;
+      }
+      else if (it->second.type != type)
+      {
+        throw std::logic_error(fmt::format(
+          "Metric {} is already registered as a {}", name, it->second.type));
+      }
+      return it->second;
+    }
+
+    template <typename T>
+    T& get_or_add(
+      const std::string& name,
+      const std::string& help,
+      const char* type,
+      Labels labels,
+      double scale = 1)
+    {
+      std::lock_guard guard(lock);
+      auto& family = get_family(name, help, type);
+      for (const auto& series : family.series)
+      {
+        if (series.labels == labels)
+        {
+          // Only metrics owned by the registry are ever returned, so the
+          // const_cast is safe.
+          return const_cast<T&>(*std::get<const T*>(series.metric));
+        }
+      }
+
+      auto& metric = storage<T>().emplace_back();
+      family.series.push_back({std::move(labels), scale, &metric});
+      return metric;
+    }
+
+    static std::string format_labels(
+      const Labels& labels,
+      std::optional<std::pair<std::string, std::string>> extra = std::nullopt)
+    {
+      if (labels.empty() && !extra.has_value())
+      {
+        return "";
+      }
+
+      fmt::memory_buffer out;
+      auto it = std::back_inserter(out);
+      auto append = [&](const std::string& key, const std::string& value) {
+        fmt::format_to(it, "{}{}=\"", out.size() > 1 ? "," : "", key);
+        for (char c : value)
+        {
+          switch (c)
+          {
+            case '\\':
+              fmt::format_to(it, "\\\\");
+              break;
+            case '"':
+              fmt::format_to(it, "\\\"");
+              break;
+            case '\n':
+              fmt::format_to(it, "\\n");
+              break;
+            default:
+              out.push_back(c);
+          }
+        }
+        out.push_back('"');
+      };
+
+      out.push_back('{');
+      for (const auto& [key, value] : labels)
+      {
+        append(key, value);
+      }
+      if (extra.has_value())
+      {
+        append(extra->first, extra->second);
+      }
+      out.push_back('}');
+      return fmt::to_string(out);
+    }
+
+    template <typename It>
+    static void render(It it, const std::string& name, const Series& series)
+    {
+      const auto labels = format_labels(series.labels);
+      if (const auto* counter = std::get_if<const Counter*>(&series.metric))
+      {
+        fmt::format_to(it, "{}{} {}\n", name, labels, (*counter)->get());
+      }
+      else if (const auto* gauge = std::get_if<const Gauge*>(&series.metric))
+      {
+        fmt::format_to(it, "{}{} {}\n", name, labels, (*gauge)->get());
+      }
+      else if (const auto* cb = std::get_if<Callback>(&series.metric))
+      {
+        fmt::format_to(it, "{}{} {}\n", name, labels, cb->fn());
+      }
+      else
+      {
+        const auto* histogram = std::get<const Histogram*>(series.metric);
+
+        // Prometheus buckets are cumulative.
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < Histogram::BUCKET_COUNT; i++)
+        {
+          cumulative += histogram->get_bucket(i);
+          auto le = i + 1 < Histogram::BUCKET_COUNT ?
+            fmt::format(
+              "{}", Histogram::bucket_upper_bound(i) * series.scale) :
+            std::string("+Inf");
+          fmt::format_to(
+            it,
+            "{}_bucket{} {}\n",
+            name,
+            format_labels(series.labels, {{"le", le}}),
+            cumulative);
+        }
+        fmt::format_to(
+          it,
+          "{}_sum{} {}\n",
+          name,
+          labels,
+          histogram->get_sum() * series.scale);
+        fmt::format_to(
+          it, "{}_count{} {}\n", name, labels, histogram->get_count());
+      }
+    }
+  };
+
+  /**
+   * The registry of all metrics exported by this node.
+   */
+  inline Registry& registry()
+  {
+    static Registry instance;
+    return instance;
+  }
+}
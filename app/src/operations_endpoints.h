@@ -1,15 +1,34 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 
+#pragma once
+
 #include "app_data.h"
+#include "call_types.h"
 #include "cbor.h"
+#include "constants.h"
 #include "historical/historical_queries_adapter.h"
+#include "http_error.h"
+#include "indexing/catch_up_estimator.h"
+#include "indexing/expiry_window_search.h"
+#include "indexing/operation_waiters.h"
+#include "indexing/seqno_ring.h"
+#include "kv_types.h"
+#include "metrics.h"
 #include "odata_error.h"
 #include "visit_each_entry_in_value.h"
 
+#include <algorithm>
+#include <atomic>
+#include <ccf/historical_queries_interface.h>
+#include <ccf/http_query.h>
 #include <ccf/json_handler.h>
 #include <ccf/node_context.h>
+#include <ccf/rpc_responder.h>
 #include <ccf/service/tables/nodes.h>
+#include <charconv>
+#include <limits>
+#include <shared_mutex>
 
 namespace scitt
 {
@@ -18,12 +37,27 @@ namespace scitt
    *
    * The state can be one of "running", "failed" or "succeeded". In the last
    * case, the transaction ID which completed the operation is recorded.
+   *
+   * State transitions are read from the operations table. Synchronous
+   * operations, which complete in the same transaction that writes to the
+   * entry table, are derived from the entry table instead.
    */
   class OperationsIndexingStrategy
     : public VisitEachEntryInValueTyped<OperationsTable>
   {
   public:
-    OperationsIndexingStrategy(ccf::BaseEndpointRegistry& registry) :
+    /**
+     * Get the sequence numbers of the transactions which wrote to the
+     * operations table in an inclusive range, or std::nullopt if they are
+     * still being fetched. The range is kept the same until it has been
+     * fetched.
+     */
+    using FindOperationLogs = std::function<std::optional<
+      std::vector<ccf::SeqNo>>(ccf::SeqNo from, ccf::SeqNo to)>;
+
+    OperationsIndexingStrategy(
+      ccf::BaseEndpointRegistry& registry,
+      ccf::historical::AbstractStateCache& state_cache) :
       OperationsIndexingStrategy(
         [&registry](timespec& time) {
           return registry.get_untrusted_host_time_v1(time);
@@ -31,6 +65,31 @@ namespace scitt
         [&registry](
           ccf::View view, ccf::SeqNo seqno, ccf::TxStatus& tx_status) {
           return registry.get_status_for_txid_v1(view, seqno, tx_status);
+        },
+        [&registry](ccf::SeqNo& seqno) {
+          ccf::View view;
+          return registry.get_last_committed_txid_v1(view, seqno);
+        },
+        [&state_cache](ccf::SeqNo from, ccf::SeqNo to)
+          -> std::optional<std::vector<ccf::SeqNo>> {
+          const auto stores =
+            state_cache.get_store_range(OPERATION_LOG_SEARCH_HANDLE, from, to);
+          if (stores.empty())
+          {
+            return std::nullopt;
+          }
+
+          std::vector<ccf::SeqNo> seqnos;
+          for (size_t i = 0; i < stores.size(); i++)
+          {
+            auto tx = stores[i]->create_read_only_tx();
+            if (tx.template ro<OperationsTable>(OPERATIONS_TABLE)->has())
+            {
+              seqnos.push_back(from + i);
+            }
+          }
+          state_cache.drop_cached_states(OPERATION_LOG_SEARCH_HANDLE);
+          return seqnos;
         })
     {}
 
@@ -38,10 +97,15 @@ namespace scitt
       std::function<ccf::ApiResult(timespec& time)> get_time,
       std::function<ccf::ApiResult(
         ccf::View view, ccf::SeqNo seqno, ccf::TxStatus& tx_status)>
-        get_status_for_txid) :
+        get_status_for_txid,
+      std::function<ccf::ApiResult(ccf::SeqNo& seqno)>
+        get_last_committed_seqno,
+      FindOperationLogs find_operation_logs) :
       VisitEachEntryInValueTyped(OPERATIONS_TABLE),
       get_time(get_time),
-      get_status_for_txid(get_status_for_txid)
+      get_status_for_txid(get_status_for_txid),
+      get_last_committed_seqno(get_last_committed_seqno),
+      find_operation_logs(std::move(find_operation_logs))
     {}
 
     /**
@@ -56,11 +120,502 @@ namespace scitt
      * In some cases however, we can be confident that this transaction ID is
      * invalid now and forever in the future. In these cases, an appropriate
      * HTTPError exception is thrown.
+     *
+     * Lookups only take a shared lock on the strategy's state, and never hold
+     * it while calling into CCF, such that many threads can serve them
+     * concurrently without blocking the indexer.
      */
     GetOperation::Out lookup(const ccf::TxID& operation_id) const
+    {
+      // An operation which has been indexed was necessarily committed, so
+      // there is no need to ask CCF about its status. This is the common case
+      // for clients polling an operation until it completes.
+      {
+        std::shared_lock guard(lock);
+        if (
+          operation_id.seqno >= lower_bound &&
+          operation_id.seqno < upper_bound)
+        {
+          const auto* state = operations_.find(operation_id.seqno);
+          if (state != nullptr && state->view == operation_id.view)
+          {
+            return make_operation(operation_id, *state);
+          }
+        }
+      }
+
+      const auto tx_status = get_tx_status(operation_id);
+      std::shared_lock guard(lock);
+      return lookup_locked(operation_id, tx_status);
+    }
+
+    /**
+     * Look up many operations at once, from a single snapshot of the index.
+     *
+     * Operation IDs for which lookup() would reject the request, for instance
+     * because the operation has expired or never existed, are reported with
+     * a lookup error of their own. Errors which don't depend on the operation
+     * ID, such as failing to get a transaction's status, fail the whole
+     * batch, and the client should retry it.
+     */
+    std::vector<OperationLookup> lookup_batch(
+      const std::vector<ccf::TxID>& operation_ids) const
+    {
+      std::vector<ccf::TxStatus> tx_statuses;
+      tx_statuses.reserve(operation_ids.size());
+      for (const auto& operation_id : operation_ids)
+      {
+        try
+        {
+          tx_statuses.push_back(get_tx_status(operation_id));
+        }
+        catch (const HTTPError& e)
+        {
+          throw_batch_error(e);
+        }
+      }
+
+      std::vector<OperationLookup> results;
+      results.reserve(operation_ids.size());
+      std::shared_lock guard(lock);
+      for (size_t i = 0; i < operation_ids.size(); i++)
+      {
+        OperationLookup result{
+          .operation_id = operation_ids[i],
+          .operation = {},
+          .lookup_error = {},
+        };
+        try
+        {
+          result.operation = lookup_locked(operation_ids[i], tx_statuses[i]);
+        }
+        catch (const HTTPError& e)
+        {
+          if (e.status_code >= HTTP_STATUS_INTERNAL_SERVER_ERROR)
+          {
+            throw_batch_error(e);
+          }
+          result.lookup_error = ODataError{.code = e.code, .message = e.what()};
+        }
+        results.push_back(std::move(result));
+      }
+      return results;
+    }
+
+    /**
+     * Number of seconds after which a running operation is worth polling
+     * again, for use in a Retry-After header. This is based on how far behind
+     * the index is, and how fast it is catching up.
+     */
+    uint32_t get_retry_after_seconds(const ccf::TxID& operation_id)
+    {
+      {
+        std::shared_lock guard(lock);
+        if (search.has_value())
+        {
+          return indexing::CatchUpEstimator::MIN_RETRY_AFTER_SECONDS;
+        }
+      }
+      return catch_up.retry_after_seconds(
+        get_indexed_watermark().seqno, operation_id.seqno);
+    }
+
+    /**
+     * Call the given function once the operation is no longer running as far
+     * as the index can tell, or once the deadline has passed, whichever comes
+     * first. The function runs on the indexer's thread, without any lock
+     * held, and should look the operation up again.
+     *
+     * Returns false, and never calls the function, if the operation has
+     * already been indexed in a final state, or if too many requests are
+     * waiting already.
+     */
+    bool wait_for(
+      const ccf::TxID& operation_id,
+      indexing::OperationWaiters::Clock::time_point deadline,
+      indexing::OperationWaiters::Callback callback)
+    {
+      // The shared lock stops the indexer from completing the operation
+      // between the check below and adding the waiter.
+      std::shared_lock guard(lock);
+      if (!search.has_value() && operation_id.seqno < upper_bound)
+      {
+        if (operation_id.seqno < lower_bound)
+        {
+          return false;
+        }
+        const auto* state = operations_.find(operation_id.seqno);
+        if (
+          state == nullptr || state->view != operation_id.view ||
+          state->status != OperationStatus::Running)
+        {
+          return false;
+        }
+      }
+      return waiters.add(operation_id.seqno, deadline, std::move(callback));
+    }
+
+    nlohmann::json describe() override
+    {
+      auto j = VisitEachEntryInValueTyped::describe();
+      std::shared_lock guard(lock);
+      j["lower_bound"] = lower_bound;
+      j["upper_bound"] = upper_bound;
+      j["operation_count"] = operations_.size();
+      j["operation_bytes"] = operations_.size_bytes();
+      j["searching_start"] = search.has_value();
+      j["purge_runs"] = purge_runs;
+      j["purged_operations"] = purged_operations;
+      j["purge_time_us"] = purge_time.count();
+      j["waiting_requests"] = waiters.size();
+      return j;
+    }
+
+    /**
+     * Before indexing anything, the strategy looks for the first transaction
+     * that records an operation which hasn't expired yet, and starts indexing
+     * from there. Operations before it would be purged as soon as indexed,
+     * and on a long-lived ledger indexing them would delay startup by hours.
+     */
+    std::optional<ccf::SeqNo> next_requested() override
     {
       std::lock_guard guard(lock);
+      if (!search_started)
+      {
+        start_search();
+      }
+      if (search.has_value())
+      {
+        skip_to_operation_log();
+      }
+      if (search.has_value())
+      {
+        return search->next_probe();
+      }
+      return std::max(
+        VisitEachEntryInValueTyped::next_requested().value_or(lower_bound),
+        lower_bound);
+    }
+
+    void handle_committed_transaction(
+      const ccf::TxID& tx_id, const ccf::kv::ReadOnlyStorePtr& store) override
+    {
+      index_transaction(tx_id, store);
+      notify_waiters();
+    }
+
+    /**
+     * Called periodically by the indexer, whether or not there are new
+     * transactions. This lets operations expire on a ledger that isn't
+     * receiving any, and requests stop waiting for operations that don't
+     * complete in time.
+     */
+    void tick() override
+    {
+      VisitEachEntryInValueTyped::tick();
+
+      timespec current_time;
+      if (get_time(current_time) == ccf::ApiResult::OK)
+      {
+        std::lock_guard guard(lock);
+        if (!search.has_value())
+        {
+          host_time = std::max(host_time, current_time.tv_sec);
+          maybe_purge_operations();
+        }
+      }
+
+      waiters.complete_expired();
+      notify_waiters();
+    }
 
+  protected:
+    void visit_entry(const ccf::TxID& tx_id, const OperationLog& log) override
+    {
+      std::lock_guard guard(lock);
+      record_operation(tx_id, log);
+    }
+
+    /**
+     * Record a transaction fetched while looking for the start of the expiry
+     * window, with the creation time of the operation it records, if any.
+     */
+    void visit_search_probe(ccf::SeqNo seqno, std::optional<time_t> created_at)
+    {
+      std::lock_guard guard(lock);
+      if (search.has_value())
+      {
+        record_search_probe(seqno, created_at);
+      }
+    }
+
+    /**
+     * Record a synchronous operation from a transaction which wrote to the
+     * entry table but not to the operations table. It is as old as the latest
+     * time recorded in the ledger.
+     */
+    void visit_synchronous_entry(const ccf::TxID& tx_id)
+    {
+      std::lock_guard guard(lock);
+      record_operation(
+        tx_id,
+        OperationLog{
+          .status = OperationStatus::Succeeded,
+          .operation_id = {},
+          .created_at = ledger_time,
+          .context_digest = {},
+          .error = {}});
+    }
+
+  private:
+    // Operation creation times come from the untrusted clock of whichever
+    // node created them, and are not strictly increasing across nodes. Start
+    // indexing a little earlier than strictly needed to account for that.
+    static constexpr std::chrono::seconds CLOCK_SKEW_MARGIN{5 * 60};
+
+    // Minimum amount of time between two purges of expired operations.
+    static constexpr std::chrono::seconds PURGE_INTERVAL{60};
+
+    // Number of transactions fetched from the host at once while looking for
+    // the next operation log, and the handle of those historical queries.
+    // Handles of the historical query adapter are sequence numbers, which
+    // never go this high.
+    static constexpr size_t OPERATION_LOG_SEARCH_RANGE = 1000;
+    static constexpr ccf::historical::RequestHandle
+      OPERATION_LOG_SEARCH_HANDLE =
+        std::numeric_limits<ccf::historical::RequestHandle>::max();
+
+    /**
+     * Index a committed transaction, leaving the requests which stopped
+     * waiting for it to notify_waiters().
+     */
+    void index_transaction(
+      const ccf::TxID& tx_id, const ccf::kv::ReadOnlyStorePtr& store)
+    {
+      {
+        std::lock_guard guard(lock);
+        if (search.has_value())
+        {
+          auto tx = store->create_read_only_tx();
+          auto log = tx.template ro<OperationsTable>(OPERATIONS_TABLE)->get();
+          record_search_probe(
+            tx_id.seqno,
+            log.has_value() && !log->operation_id.has_value() ?
+              log->created_at :
+              std::nullopt);
+          return;
+        }
+
+        if (tx_id.seqno < lower_bound)
+        {
+          return;
+        }
+      }
+
+      // Synchronous registrations only write to the entry table, except for
+      // the occasional one which also records the time in the operations
+      // table. Older ledgers have an operation log for every entry, and are
+      // indexed through visit_entry() alone.
+      auto tx = store->create_read_only_tx();
+      const bool has_log =
+        tx.template ro<OperationsTable>(OPERATIONS_TABLE)->has();
+
+      VisitEachEntryInValueTyped::handle_committed_transaction(tx_id, store);
+
+      if (!has_log && tx.template ro<EntryTable>(ENTRY_TABLE)->has())
+      {
+        visit_synchronous_entry(tx_id);
+      }
+    }
+
+    void start_search()
+    {
+      search_started = true;
+
+      ccf::SeqNo committed_seqno;
+      auto result = get_last_committed_seqno(committed_seqno);
+      if (result != ccf::ApiResult::OK)
+      {
+        SCITT_FAIL(
+          "Failed to get last committed transaction, indexing all operations: "
+          "{}",
+          ccf::api_result_to_str(result));
+        return;
+      }
+
+      timespec current_time;
+      result = get_time(current_time);
+      if (result != ccf::ApiResult::OK)
+      {
+        SCITT_FAIL(
+          "Failed to get host time, indexing all operations: {}",
+          ccf::api_result_to_str(result));
+        return;
+      }
+
+      const time_t cutoff = current_time.tv_sec - OPERATION_EXPIRY.count() -
+        CLOCK_SKEW_MARGIN.count();
+      const auto first_seqno =
+        VisitEachEntryInValueTyped::next_requested().value_or(lower_bound);
+      search.emplace(first_seqno, committed_seqno + 1, cutoff);
+      if (search->done())
+      {
+        finish_search();
+      }
+    }
+
+    // Must be called with the lock held exclusively, while searching.
+    void record_search_probe(ccf::SeqNo seqno, std::optional<time_t> created_at)
+    {
+      search->record(seqno, created_at);
+      if (search->done())
+      {
+        finish_search();
+      }
+    }
+
+    /**
+     * Move the search's next probe to the next transaction which wrote to the
+     * operations table, rather than wait for the indexer to fetch every
+     * transaction before it. Operation logs can be thousands of transactions
+     * apart, or more on a ledger which was idle for a while.
+     *
+     * Transactions are fetched from the host OPERATION_LOG_SEARCH_RANGE at a
+     * time, starting from the probe, so the search never depends on anything
+     * having indexed the ledger from the start. The indexer keeps feeding the
+     * probe itself in the meantime, which may move it within the range being
+     * fetched.
+     */
+    void skip_to_operation_log()
+    {
+      while (!search->done())
+      {
+        const auto probe = search->next_probe();
+        if (
+          !operation_log_range.has_value() ||
+          probe < operation_log_range->first ||
+          probe >= operation_log_range->second)
+        {
+          operation_log_range = {
+            probe,
+            std::min<ccf::SeqNo>(
+              search->probe_end(), probe + OPERATION_LOG_SEARCH_RANGE)};
+        }
+
+        const auto [from, to] = operation_log_range.value();
+        const auto seqnos = find_operation_logs(from, to - 1);
+        if (!seqnos.has_value())
+        {
+          return;
+        }
+        operation_log_range.reset();
+
+        auto it = std::lower_bound(seqnos->begin(), seqnos->end(), probe);
+        if (it != seqnos->end())
+        {
+          search->skip_to(*it);
+          return;
+        }
+        search->skip_to(to);
+      }
+      finish_search();
+    }
+
+    void finish_search()
+    {
+      // Any operation before this was created too long ago, and lookups for
+      // it will report it as expired.
+      lower_bound = search->result();
+      upper_bound = std::max(upper_bound, lower_bound);
+
+      // Entries indexed before the next operation log don't have a time of
+      // their own. They were registered around the start of the window.
+      ledger_time = std::max(ledger_time, search->get_cutoff());
+      search.reset();
+      operation_log_range.reset();
+      waiters.complete_range(0, lower_bound);
+
+      SCITT_INFO("Indexing operations from seqno {}", lower_bound);
+    }
+
+    /**
+     * Apply an operation log, whether read from the ledger or derived from an
+     * entry. Must be called with the lock held exclusively.
+     */
+    void record_operation(const ccf::TxID& tx_id, const OperationLog& log)
+    {
+      const auto previous_upper_bound = upper_bound;
+      handle_transition(tx_id, log);
+
+      if (log.created_at.has_value())
+      {
+        ledger_time = std::max(ledger_time, log.created_at.value());
+      }
+      maybe_purge_operations();
+
+      upper_bound = tx_id.seqno + 1;
+
+      // Transactions skipped since the previous operation log, and this one
+      // unless it started an operation, are now known not to be operations.
+      waiters.complete_range(previous_upper_bound, tx_id.seqno);
+      if (operations_.find(tx_id.seqno) == nullptr)
+      {
+        waiters.complete(tx_id.seqno);
+      }
+    }
+
+    /**
+     * Run the callbacks of the requests which stopped waiting. Must be called
+     * without the lock held, since they look operations up again.
+     */
+    void notify_waiters()
+    {
+      for (auto& callback : waiters.take_completed())
+      {
+        try
+        {
+          callback();
+        }
+        catch (const std::exception& e)
+        {
+          SCITT_FAIL("Failed to respond to a waiting request: {}", e.what());
+        }
+      }
+    }
+
+    /**
+     * Operations expire against the later of the time recorded in the ledger
+     * and the host time seen by tick(). The former needs no host call for
+     * each replayed transaction, while the latter keeps the clock moving on
+     * a ledger which isn't receiving any transactions. Must be called with
+     * the lock held exclusively.
+     */
+    void maybe_purge_operations()
+    {
+      const time_t now = std::max(ledger_time, host_time);
+      if (now - last_purge_time >= PURGE_INTERVAL.count())
+      {
+        purge_operations(now);
+        last_purge_time = now;
+      }
+    }
+
+    struct OperationState;
+
+    /**
+     * Fail a whole batch lookup because of a server-side error, which may well
+     * go away if the client tries again.
+     */
+    [[noreturn]] static void throw_batch_error(const HTTPError& e)
+    {
+      throw ServiceUnavailableCborError(
+        e.code,
+        e.what(),
+        indexing::CatchUpEstimator::MIN_RETRY_AFTER_SECONDS);
+    }
+
+    ccf::TxStatus get_tx_status(const ccf::TxID& operation_id) const
+    {
       ccf::TxStatus tx_status;
       auto result =
         get_status_for_txid(operation_id.view, operation_id.seqno, tx_status);
@@ -71,6 +626,16 @@ namespace scitt
           ccf::api_result_to_str(result)));
       }
 
+      return tx_status;
+    }
+
+    /**
+     * Look up an operation whose transaction has the given status. Must be
+     * called with the lock held, in either mode.
+     */
+    GetOperation::Out lookup_locked(
+      const ccf::TxID& operation_id, ccf::TxStatus tx_status) const
+    {
       switch (tx_status)
       {
         case ccf::TxStatus::Unknown:
@@ -125,20 +690,15 @@ namespace scitt
           .entry_id = {},
           .error = {}};
       }
-      else if (auto it = operations_.find(operation_id.seqno);
-               it != operations_.end())
+      else if (const auto* state = operations_.find(operation_id.seqno);
+               state != nullptr)
       {
-        if (operation_id.view != it->second.view)
+        if (operation_id.view != state->view)
         {
           throw BadRequestCborError(
             errors::InvalidInput, "Operation ID has inconsistent view");
         }
-        return {
-          .operation_id = operation_id,
-          .status = it->second.status,
-          .entry_id = it->second.completion_tx,
-          .error = it->second.error,
-        };
+        return make_operation(operation_id, *state);
       }
       else
       {
@@ -149,18 +709,50 @@ namespace scitt
       }
     }
 
-  protected:
-    void visit_entry(const ccf::TxID& tx_id, const OperationLog& log) override
+    // Must be called with the lock held, in either mode.
+    GetOperation::Out make_operation(
+      const ccf::TxID& operation_id, const OperationState& state) const
     {
-      std::lock_guard guard(lock);
-
-      handle_transition(tx_id, log);
-      purge_operations();
+      GetOperation::Out out{
+        .operation_id = operation_id,
+        .status = state.status,
+        .entry_id = {},
+        .error = {},
+      };
+      if (state.status == OperationStatus::Succeeded)
+      {
+        out.entry_id = state.completion_tx;
+      }
+      else if (auto it = errors_.find(operation_id.seqno); it != errors_.end())
+      {
+        out.error = it->second;
+      }
+      return out;
+    }
 
-      upper_bound = tx_id.seqno + 1;
+    /**
+     * Convert an error read from the operations table. Errors are recorded
+     * by whatever completed the operation, possibly with an older version of
+     * the service, so they may lack some of the fields of an ODataError.
+     */
+    static ODataError to_odata_error(const nlohmann::json& error)
+    {
+      ODataError out{.code = errors::InternalError, .message = error.dump()};
+      if (error.is_object())
+      {
+        if (auto it = error.find("code"); it != error.end() && it->is_string())
+        {
+          out.code = it->template get<std::string>();
+        }
+        if (auto it = error.find("message");
+            it != error.end() && it->is_string())
+        {
+          out.message = it->template get<std::string>();
+        }
+      }
+      return out;
     }
 
-  private:
     void handle_transition(const ccf::TxID& tx_id, const OperationLog& log)
     {
       ccf::TxID operation_id = log.operation_id.value_or(tx_id);
@@ -169,41 +761,51 @@ namespace scitt
         return;
       }
 
-      auto it = operations_.find(operation_id.seqno);
-      if (!(it == operations_.end()) || (operation_id.view == it->second.view))
+      auto* state = operations_.find(operation_id.seqno);
+      if (state != nullptr && operation_id.view != state->view)
       {
         throw BadRequestCborError(
           errors::InvalidInput, "Operation ID has inconsistent view");
       }
 
-      auto current_status = it != operations_.end() ?
-        std::optional(it->second.status) :
-        std::nullopt;
+      auto current_status =
+        state != nullptr ? std::optional(state->status) : std::nullopt;
       if (!check_transition(tx_id, operation_id, current_status, log))
       {
         return;
       }
 
-      if (it == operations_.end())
+      if (state == nullptr)
       {
-        it = operations_.emplace(operation_id.seqno, OperationState{}).first;
-        it->second.view = operation_id.view;
-        it->second.created_at = log.created_at.value();
+        state = &operations_.push_back(
+          operation_id.seqno,
+          OperationState{
+            .view = operation_id.view,
+            .created_at = log.created_at.value(),
+          });
       }
 
-      it->second.status = log.status;
+      state->status = log.status;
       switch (log.status)
       {
         case OperationStatus::Running:
-          it->second.context_digest = log.context_digest;
           break;
         case OperationStatus::Failed:
-          it->second.error = log.error;
+          if (log.error.has_value())
+          {
+            errors_.insert_or_assign(
+              operation_id.seqno, to_odata_error(log.error.value()));
+          }
           break;
         case OperationStatus::Succeeded:
-          it->second.completion_tx = tx_id;
+          state->completion_tx = tx_id;
           break;
       }
+
+      if (log.status != OperationStatus::Running)
+      {
+        waiters.complete(operation_id.seqno);
+      }
     }
 
     /**
@@ -298,65 +900,91 @@ namespace scitt
      * keeping a bound on how many operations we keep around.
      *
      * Because operation IDs are monotonically increasing, and we keep them
-     * ordered in an std::map, we can scan from the front and stop as soon as a
-     * non-expired entry is found.
+     * ordered, we can pop from the front and stop as soon as a non-expired
+     * entry is found.
+     *
+     * This runs at most once per PURGE_INTERVAL, so operations may be kept
+     * around for up to that long after they expire.
      */
-    void purge_operations()
+    void purge_operations(time_t now)
     {
-      timespec current_time;
-      auto result = get_time(current_time);
-      if (result != ccf::ApiResult::OK)
-      {
-        SCITT_FAIL(
-          "Failed to get host time: {}", ccf::api_result_to_str(result));
-      }
+      const auto start = std::chrono::steady_clock::now();
 
-      auto it = operations_.begin();
-      while (it != operations_.end())
+      size_t removed = 0;
+      while (!operations_.empty())
       {
-        double age = difftime(current_time.tv_sec, it->second.created_at);
-        if (age > OPERATION_EXPIRY.count())
-        {
-          it++;
-        }
-        else
+        const auto& oldest = operations_.front();
+        double age = difftime(now, oldest.value.created_at);
+        if (age <= OPERATION_EXPIRY.count())
         {
           break;
         }
+
+        lower_bound = oldest.seqno + 1;
+        operations_.pop_front();
+        removed++;
       }
 
-      if (it != operations_.begin())
+      if (removed > 0)
       {
-        SCITT_INFO(
-          "Removing {} operations from indexing strategy",
-          std::distance(operations_.begin(), it));
-
-        lower_bound = std::prev(it)->first + 1;
-        operations_.erase(operations_.begin(), it);
+        SCITT_INFO("Removing {} operations from indexing strategy", removed);
+        errors_.erase(errors_.begin(), errors_.lower_bound(lower_bound));
+        waiters.complete_range(0, lower_bound);
       }
+
+      purge_runs++;
+      purged_operations += removed;
+      purge_time += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
     }
 
     const std::function<ccf::ApiResult(timespec& time)> get_time;
     const std::function<ccf::ApiResult(
       ccf::View view, ccf::SeqNo seqno, ccf::TxStatus& tx_status)>
       get_status_for_txid;
+    const std::function<ccf::ApiResult(ccf::SeqNo& seqno)>
+      get_last_committed_seqno;
+    const FindOperationLogs find_operation_logs;
+
+    // Latest operation creation time seen in the ledger, latest host time
+    // seen by tick(), and the later of the two when operations were last
+    // purged.
+    time_t ledger_time = 0;
+    time_t host_time = 0;
+    time_t last_purge_time = 0;
+
+    // Statistics about purging, reported by describe().
+    size_t purge_runs = 0;
+    size_t purged_operations = 0;
+    std::chrono::microseconds purge_time{0};
+
+    // Set until the start of the expiry window has been found, along with the
+    // half-open range of transactions being fetched to look for the next
+    // operation log.
+    bool search_started = false;
+    std::optional<indexing::ExpiryWindowSearch> search;
+    std::optional<std::pair<ccf::SeqNo, ccf::SeqNo>> operation_log_range;
 
     struct OperationState
     {
-      // The std::map uses SeqNo as its key because TxIDs aren't totally
-      // ordered.
-      ccf::View view;
-      OperationStatus status;
-      time_t created_at;
-      std::optional<ccf::TxID> completion_tx;
-      std::optional<ODataError> error;
-      std::optional<ccf::crypto::Sha256Hash> context_digest;
+      // Operations are keyed by SeqNo because TxIDs aren't totally ordered.
+      ccf::View view = 0;
+      time_t created_at = 0;
+      OperationStatus status = OperationStatus::Running;
+
+      // Only meaningful once the operation has succeeded.
+      ccf::TxID completion_tx = {};
     };
 
-    // It might be worth replacing this with a deque. Entries are only ever
-    // inserted in monotonically increasing sequence numbers, which would
-    // make them sorted and amenable to binary searches.
-    std::map<ccf::SeqNo, OperationState> operations_;
+    // Operations are only ever created in increasing sequence number order,
+    // and expire in that same order, so they are kept in a flat ring rather
+    // than a tree.
+    indexing::SeqNoRing<OperationState> operations_;
+
+    // Errors of failed operations, as recorded in the ledger. These are rare,
+    // and kept separately so as not to make every operation's state larger.
+    // They are converted when indexed, rather than on every lookup.
+    std::map<ccf::SeqNo, ODataError> errors_;
 
     // These represent the ranges covered by the indexing strategy.
     // The lower bound is inclusive and the upper bound exclusive.
@@ -367,7 +995,14 @@ namespace scitt
     ccf::SeqNo lower_bound = 0;
     ccf::SeqNo upper_bound = 0;
 
-    mutable std::mutex lock;
+    indexing::CatchUpEstimator catch_up;
+
+    // Requests waiting for an operation to complete. These have their own
+    // lock, so they can be added while holding this one in shared mode.
+    indexing::OperationWaiters waiters{MAX_WAITING_OPERATION_REQUESTS};
+
+    // Lookups take this in shared mode, and the indexer in exclusive mode.
+    mutable std::shared_mutex lock;
   };
 
   namespace endpoints
@@ -387,6 +1022,138 @@ namespace scitt
       }
       return index->lookup(tx_id.value());
     }
+
+    /**
+     * How long the client asked to wait for a running operation to complete,
+     * from the optional "wait" query parameter, in seconds.
+     */
+    static std::chrono::seconds get_wait(ccf::endpoints::EndpointContext& ctx)
+    {
+      const auto parsed_query =
+        ccf::http::parse_query(ctx.rpc_ctx->get_request_query());
+      const auto it = parsed_query.find("wait");
+      if (it == parsed_query.end())
+      {
+        return std::chrono::seconds(0);
+      }
+
+      const std::string_view value = it->second;
+      uint32_t seconds = 0;
+      const auto [end, ec] =
+        std::from_chars(value.data(), value.data() + value.size(), seconds);
+      if (
+        ec != std::errc() || end != value.data() + value.size() ||
+        seconds > MAX_OPERATION_WAIT.count())
+      {
+        throw BadRequestCborError(
+          errors::QueryParameterError,
+          fmt::format(
+            "Invalid value for query parameter 'wait': must be between 0 and "
+            "{}",
+            MAX_OPERATION_WAIT.count()));
+      }
+      return std::chrono::seconds(seconds);
+    }
+
+    /**
+     * Fill in the response to /operations/{txid}.
+     */
+    static void set_operation_response(
+      OperationsIndexingStrategy& index,
+      ccf::RpcContext& rpc_ctx,
+      const GetOperation::Out& operation)
+    {
+      if (operation.status == OperationStatus::Running)
+      {
+        rpc_ctx.set_response_status(HTTP_STATUS_ACCEPTED);
+        rpc_ctx.set_response_header(
+          "Retry-After",
+          std::to_string(
+            index.get_retry_after_seconds(operation.operation_id)));
+        return;
+      }
+
+      std::optional<std::string> host =
+        rpc_ctx.get_request_header(ccf::http::headers::HOST);
+      if (
+        host.has_value() && operation.status == OperationStatus::Succeeded &&
+        operation.entry_id.has_value())
+      {
+        rpc_ctx.set_response_header(
+          ccf::http::headers::LOCATION,
+          fmt::format(
+            "https://{}/entries/{}",
+            host.value(),
+            operation.entry_id.value().to_str()));
+      }
+
+      rpc_ctx.set_response_status(HTTP_STATUS_OK);
+      rpc_ctx.set_response_header(
+        ccf::http::headers::CONTENT_TYPE,
+        ccf::http::headervalues::contenttype::CBOR);
+      rpc_ctx.set_response_body(operation_to_cbor(operation));
+    }
+
+    /**
+     * A request whose response is sent after its handler has returned. This
+     * is enough of an endpoint context for generic_error_adapter.
+     */
+    struct PendingRequest
+    {
+      std::shared_ptr<ccf::RpcContext> rpc_ctx;
+    };
+
+    /**
+     * Send the response of a request whose handler set response_is_pending,
+     * once it has been filled in.
+     */
+    static void send_pending_response(
+      ccf::AbstractNodeContext& context, ccf::RpcContext& rpc_ctx)
+    {
+      auto responder = context.get_subsystem<ccf::AbstractRPCResponder>();
+      if (responder == nullptr)
+      {
+        SCITT_FAIL("No RPC responder to send a pending response with");
+        return;
+      }
+      responder->reply_async(
+        rpc_ctx.get_session_context()->client_session_id,
+        false,
+        rpc_ctx.serialise_response());
+    }
+
+    static std::vector<OperationLookup> get_operations_batch(
+      const std::shared_ptr<OperationsIndexingStrategy>& index,
+      ccf::endpoints::EndpointContext& ctx)
+    {
+      std::vector<std::string> tx_id_strs;
+      try
+      {
+        tx_id_strs = cbor::decode_text_array(
+          ctx.rpc_ctx->get_request_body(), MAX_OPERATIONS_PER_BATCH);
+      }
+      catch (const std::invalid_argument& e)
+      {
+        throw BadRequestCborError(
+          errors::InvalidInput,
+          fmt::format("Invalid list of operation IDs: {}", e.what()));
+      }
+
+      std::vector<ccf::TxID> tx_ids;
+      tx_ids.reserve(tx_id_strs.size());
+      for (const auto& tx_id_str : tx_id_strs)
+      {
+        const auto tx_id = ccf::TxID::from_str(tx_id_str);
+        if (!tx_id.has_value())
+        {
+          throw BadRequestCborError(
+            errors::InvalidInput,
+            fmt::format("Invalid Operation ID: {}", tx_id_str));
+        }
+        tx_ids.push_back(tx_id.value());
+      }
+      return index->lookup_batch(tx_ids);
+    }
   }
 
   static void register_operations_endpoints(
@@ -396,39 +1163,58 @@ namespace scitt
   {
     using namespace std::placeholders;
 
-    auto operations_index =
-      std::make_shared<OperationsIndexingStrategy>(registry);
+    auto operations_index = std::make_shared<OperationsIndexingStrategy>(
+      registry, context.get_historical_state());
     context.get_indexing_strategies().install_strategy(operations_index);
+    metrics::registry().callback_gauge(
+      "scitt_index_watermark_seqno",
+      "Sequence number up to which each index has processed the ledger",
+      {{"index", "operations"}},
+      [operations_index] {
+        return operations_index->get_indexed_watermark().seqno;
+      });
 
-    auto get_op_with_status = [operations_index](
+    // Clients may ask to wait for a running operation to complete, rather
+    // than poll for it. The request is then parked until the index sees the
+    // operation complete, or the wait is over, and answered from the
+    // indexer's thread.
+    auto get_op_with_status = [operations_index, &context](
                                 ccf::endpoints::EndpointContext& ctx) {
       auto operation = endpoints::get_operation(operations_index, ctx, {});
-      if (operation.status == OperationStatus::Running)
+      const auto wait = endpoints::get_wait(ctx);
+      if (operation.status == OperationStatus::Running && wait.count() > 0)
       {
-        ctx.rpc_ctx->set_response_status(HTTP_STATUS_ACCEPTED);
-      }
-      else
-      {
-        std::optional<std::string> host =
-          ctx.rpc_ctx->get_request_header(ccf::http::headers::HOST);
-        if (
-          host.has_value() && operation.status == OperationStatus::Succeeded &&
-          operation.entry_id.has_value())
+        using PendingRequest = endpoints::PendingRequest;
+        auto respond = [operations_index,
+                        &context,
+                        operation_id = operation.operation_id,
+                        request = PendingRequest{ctx.rpc_ctx}]() mutable {
+          generic_error_adapter<
+            std::function<void(PendingRequest&)>,
+            PendingRequest>([&](PendingRequest& pending) {
+            endpoints::set_operation_response(
+              *operations_index,
+              *pending.rpc_ctx,
+              operations_index->lookup(operation_id));
+          })(request);
+          endpoints::send_pending_response(context, *request.rpc_ctx);
+        };
+
+        // Mark the response as pending first, since it may be sent as soon
+        // as the request starts waiting.
+        ctx.rpc_ctx->response_is_pending = true;
+        if (operations_index->wait_for(
+              operation.operation_id,
+              indexing::OperationWaiters::Clock::now() + wait,
+              std::move(respond)))
         {
-          ctx.rpc_ctx->set_response_header(
-            ccf::http::headers::LOCATION,
-            fmt::format(
-              "https://{}/entries/{}",
-              host.value(),
-              operation.entry_id.value().to_str()));
+          return;
         }
-
-        ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
-        ctx.rpc_ctx->set_response_header(
-          ccf::http::headers::CONTENT_TYPE,
-          ccf::http::headervalues::contenttype::CBOR);
-        ctx.rpc_ctx->set_response_body(operation_to_cbor(operation));
+        ctx.rpc_ctx->response_is_pending = false;
       }
+
+      endpoints::set_operation_response(
+        *operations_index, *ctx.rpc_ctx, operation);
     };
 
     /**
@@ -439,15 +1225,79 @@ namespace scitt
       .make_endpoint(
         "/operations/{txid}", HTTP_GET, get_op_with_status, authn_policy)
       .set_forwarding_required(ccf::endpoints::ForwardingRequired::Never)
+      .add_query_parameter<uint32_t>(
+        "wait", ccf::endpoints::QueryParamPresence::OptionalParameter)
+      .install();
+
+    auto get_ops_batch = [operations_index](
+                           ccf::endpoints::EndpointContext& ctx) {
+      auto lookups = endpoints::get_operations_batch(operations_index, ctx);
+
+      std::vector<std::vector<uint8_t>> encoded;
+      encoded.reserve(lookups.size());
+      for (const auto& lookup : lookups)
+      {
+        encoded.push_back(operation_lookup_to_cbor(lookup));
+      }
+
+      ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
+      ctx.rpc_ctx->set_response_header(
+        ccf::http::headers::CONTENT_TYPE,
+        ccf::http::headervalues::contenttype::CBOR);
+      ctx.rpc_ctx->set_response_body(
+        cbor::encoded_items_to_cbor_array(encoded));
+    };
+
+    /**
+     * This endpoint is not part of the RFC, but lets clients check on many
+     * operations at once. The request body is a CBOR array of operation IDs,
+     * and the response is a CBOR array with the state of each operation, in
+     * the same format as /operations/{txid}. Operation IDs which
+     * /operations/{txid} would reject have a "LookupError" instead of a
+     * "Status", in the same format as an operation's "Error".
+     */
+    registry
+      .make_endpoint(
+        "/operations/status", HTTP_POST, get_ops_batch, authn_policy)
+      .set_forwarding_required(ccf::endpoints::ForwardingRequired::Never)
       .install();
   }
 
   /**
-   * Mark this transaction as having executed a synchronous operation.
+   * Latest time recorded in the operations table by a transaction of this
+   * node which was locally committed.
+   */
+  static std::atomic<time_t>& last_operation_clock_tick()
+  {
+    static std::atomic<time_t> last_tick = 0;
+    return last_tick;
+  }
+
+  /**
+   * Record the time of a synchronous operation in the operations table.
+   *
+   * The operations index derives synchronous operations from the writes to
+   * the entry table, and only needs the operations table to tell how old they
+   * are. Rather than a second write for every entry, each node records the
+   * time at most once per OPERATION_CLOCK_TICK_INTERVAL, and other entries
+   * are assumed to be as old as the latest recorded time.
+   *
+   * The tick only advances once the transaction is locally committed, in
+   * operation_locally_committed_func. A transaction which is retried or
+   * fails doesn't stop the next one from recording the time, at the cost of
+   * a few concurrent transactions occasionally recording it together.
    */
   static void record_synchronous_operation(
-    timespec current_time, ccf::kv::Tx& tx)
+    timespec current_time, ccf::kv::Tx& tx, AppData& app_data)
   {
+    if (
+      current_time.tv_sec - last_operation_clock_tick().load() <
+      OPERATION_CLOCK_TICK_INTERVAL.count())
+    {
+      return;
+    }
+
+    app_data.operation_clock_tick = current_time.tv_sec;
     auto operations_table = tx.template rw<OperationsTable>(OPERATIONS_TABLE);
     operations_table->put(OperationLog{
       .status = OperationStatus::Succeeded,
@@ -465,9 +1315,9 @@ namespace scitt
    * necessary to inform the client of the operation ID.
    *
    * This is called for both synchronous and asynchronous operations. In the
-   * case of synchronous operations, the operation's status has already been set
-   * to "succeeded" in the KV, and once signed, globally committed and
-   * witnessed by the indexing strategy, will be available to the client.
+   * case of synchronous operations, the entry has already been written to the
+   * KV, and once signed, globally committed and witnessed by the indexing
+   * strategy, the operation will be available to the client as "succeeded".
    *
    * For asynchronous operations, we must trigger the external process, as
    * recorded as a lambda in the AppData. Again, we can only do this now that we
@@ -485,9 +1335,20 @@ namespace scitt
     std::string tx_str = tx_id.to_str();
     SCITT_DEBUG("New operation was locally committed with tx={}", tx_str);
 
-    // Even though synchronous operations are set to "Succeeded" in the KV,
-    // they still need to go through consensus, so we tell the client it is
-    // still "running".
+    if (auto tick = get_app_data(ctx.rpc_ctx).operation_clock_tick)
+    {
+      auto& last_tick = last_operation_clock_tick();
+      time_t previous_tick = last_tick.load();
+      while (
+        previous_tick < *tick &&
+        !last_tick.compare_exchange_weak(previous_tick, *tick))
+      {
+      }
+    }
+
+    // Even though synchronous operations are complete once their entry is
+    // written, they still need to go through consensus, so we tell the client
+    // it is still "running".
     GetOperation::Out operation{
       .operation_id = tx_id,
       .status = OperationStatus::Running,
@@ -501,6 +1362,12 @@ namespace scitt
     ctx.rpc_ctx->set_response_body(operation_to_cbor(operation));
     ctx.rpc_ctx->set_response_status(HTTP_STATUS_ACCEPTED);
 
+    // The operation will typically complete within the next signature, so
+    // the client can check on it soon.
+    ctx.rpc_ctx->set_response_header(
+      "Retry-After",
+      std::to_string(indexing::CatchUpEstimator::MIN_RETRY_AFTER_SECONDS));
+
     if (auto host = ctx.rpc_ctx->get_request_header(ccf::http::headers::HOST))
     {
       ctx.rpc_ctx->set_response_header(
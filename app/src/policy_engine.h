@@ -5,12 +5,17 @@
 
 #include "cose.h"
 #include "http_error.h"
+#include "metrics.h"
+#include "policy_rules.h"
+#include "policy_verdict_cache.h"
 #include "tracing.h"
 #include "verified_details.h"
 
 #include <ccf/ds/hex.h>
 #include <ccf/js/common_context.h>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace scitt
 {
@@ -18,8 +23,333 @@ namespace scitt
 
   namespace js
   {
+    using Details = std::optional<verifier::VerifiedSevSnpAttestationDetails>;
+
+    static inline ccf::js::core::JSWrappedValue x5chain_to_js_val(
+      ccf::js::core::Context& ctx,
+      const std::vector<std::vector<uint8_t>>& x5chain)
+    {
+      auto x5_array = ctx.new_array();
+      size_t i = 0;
+
+      for (const auto& der_cert : x5chain)
+      {
+        auto pem = ccf::crypto::cert_der_to_pem(der_cert);
+        x5_array.set_at_index(i++, ctx.new_string(pem.str()));
+      }
+
+      return x5_array;
+    }
+
+    static inline ccf::js::core::JSWrappedValue tss_map_to_js_val(
+      ccf::js::core::Context& ctx, const scitt::cose::TSSMap& tss_map)
+    {
+      auto obj = ctx.new_obj();
+      if (tss_map.svc_id.has_value())
+      {
+        obj.set("svc_id", ctx.new_string(tss_map.svc_id.value()));
+      }
+      if (tss_map.attestation.has_value())
+      {
+        obj.set(
+          "attestation",
+          ctx.new_array_buffer_copy(tss_map.attestation.value()));
+      }
+      if (tss_map.attestation_type.has_value())
+      {
+        obj.set(
+          "attestation_type", ctx.new_string(tss_map.attestation_type.value()));
+      }
+      if (tss_map.cose_key.has_value())
+      {
+        auto cose_key = tss_map.cose_key.value();
+        auto cose_key_obj = ctx.new_obj();
+
+        if (cose_key.kty().has_value())
+        {
+          cose_key_obj.set_int64("kty", cose_key.kty().value());
+        }
+        if (cose_key.crv_n_k_pub().has_value())
+        {
+          if (std::holds_alternative<int64_t>(cose_key.crv_n_k_pub().value()))
+          {
+            cose_key_obj.set_int64(
+              "crv", std::get<int64_t>(cose_key.crv_n_k_pub().value()));
+          }
+          else if (std::holds_alternative<std::vector<uint8_t>>(
+                     cose_key.crv_n_k_pub().value()))
+          {
+            cose_key_obj.set(
+              "n",
+              ctx.new_array_buffer_copy(std::get<std::vector<uint8_t>>(
+                cose_key.crv_n_k_pub().value())));
+          }
+        }
+        if (cose_key.x_e().has_value())
+        {
+          cose_key_obj.set(
+            "x_e", ctx.new_array_buffer_copy(cose_key.x_e().value()));
+        }
+        if (cose_key.y().has_value())
+        {
+          cose_key_obj.set(
+            "y", ctx.new_array_buffer_copy(cose_key.y().value()));
+        }
+
+        obj.set("cose_key", std::move(cose_key_obj));
+
+        auto cose_key_sha256 = cose_key.to_sha256_thumb();
+        obj.set(
+          "cose_key_sha256", ctx.new_string(ccf::ds::to_hex(cose_key_sha256)));
+      }
+      if (tss_map.snp_endorsements.has_value())
+      {
+        obj.set(
+          "snp_endorsements",
+          ctx.new_array_buffer_copy(tss_map.snp_endorsements.value()));
+      }
+      if (tss_map.uvm_endorsements.has_value())
+      {
+        obj.set(
+          "uvm_endorsements",
+          ctx.new_array_buffer_copy(tss_map.uvm_endorsements.value()));
+      }
+      if (tss_map.ver.has_value())
+      {
+        obj.set_int64("ver", tss_map.ver.value());
+      }
+      return obj;
+    }
+
+    /**
+     * Properties of the policy arguments which are expensive to convert, such
+     * as certificates which must be converted to PEM, or attestation details
+     * which must be hex-encoded. They are exposed to the policy as getters,
+     * so that only the properties a policy reads are converted.
+     *
+     * The getters refer to the decoded headers, which only live as long as
+     * this object. When it is destroyed, they are detached, and reading a
+     * property which has not been read yet throws a TypeError.
+     */
+    class LazyProperties
+    {
+    public:
+      enum class Property
+      {
+        ProtectedX5chain,
+        Attestedsvc,
+        UnprotectedX5chain,
+        Measurement,
+        ReportData,
+        HostData,
+        UvmEndorsements,
+        ReportedTcb,
+        ProductName,
+      };
+
+      LazyProperties(
+        ccf::js::core::Context& ctx,
+        const scitt::cose::ProtectedHeader& phdr,
+        const scitt::cose::UnprotectedHeader& uhdr,
+        const Details& details) :
+        ctx(ctx),
+        phdr(phdr),
+        uhdr(uhdr),
+        details(details)
+      {
+        auto* rt = JS_GetRuntime(ctx);
+        if (!JS_IsRegisteredClass(rt, class_id()))
+        {
+          JSClassDef def{};
+          def.class_name = "PolicyArguments";
+          JS_NewClass(rt, class_id(), &def);
+        }
+        holder = ccf::js::core::JSWrappedValue(
+          ctx, JS_NewObjectClass(ctx, static_cast<int>(class_id())));
+        JS_SetOpaque(holder.val, this);
+      }
+
+      LazyProperties(const LazyProperties&) = delete;
+      LazyProperties& operator=(const LazyProperties&) = delete;
+
+      ~LazyProperties()
+      {
+        JS_SetOpaque(holder.val, nullptr);
+      }
+
+      /**
+       * Define a property of the given object whose value is converted from
+       * the decoded headers the first time it is read.
+       */
+      void define(ccf::js::core::JSWrappedValue& obj, Property property)
+      {
+        JSValue getter = JS_NewCFunctionData(
+          ctx, &get, 0, static_cast<int>(property), 1, &holder.val);
+        JSAtom atom = JS_NewAtom(ctx, name(property));
+        JS_DefinePropertyGetSet(
+          ctx,
+          obj.val,
+          atom,
+          getter,
+          JS_UNDEFINED,
+          JS_PROP_CONFIGURABLE | JS_PROP_ENUMERABLE);
+        JS_FreeAtom(ctx, atom);
+      }
+
+    private:
+      ccf::js::core::Context& ctx;
+      const scitt::cose::ProtectedHeader& phdr;
+      const scitt::cose::UnprotectedHeader& uhdr;
+      const Details& details;
+      ccf::js::core::JSWrappedValue holder;
+
+      static JSClassID class_id()
+      {
+        static const JSClassID id = [] {
+          JSClassID id = 0;
+          JS_NewClassID(&id);
+          return id;
+        }();
+        return id;
+      }
+
+      static const char* name(Property property)
+      {
+        switch (property)
+        {
+          case Property::ProtectedX5chain:
+          case Property::UnprotectedX5chain:
+            return "x5chain";
+          case Property::Attestedsvc:
+            return "attestedsvc";
+          case Property::Measurement:
+            return "measurement";
+          case Property::ReportData:
+            return "report_data";
+          case Property::HostData:
+            return "host_data";
+          case Property::UvmEndorsements:
+            return "uvm_endorsements";
+          case Property::ReportedTcb:
+            return "reported_tcb";
+          case Property::ProductName:
+            return "product_name";
+          default:
+            return "";
+        }
+      }
+
+      // NOLINTBEGIN(bugprone-unchecked-optional-access)
+      // Properties are only defined if the value they are converted from is
+      // present.
+      ccf::js::core::JSWrappedValue convert(Property property) const
+      {
+        switch (property)
+        {
+          case Property::ProtectedX5chain:
+            return x5chain_to_js_val(ctx, phdr.x5chain.value());
+          case Property::Attestedsvc:
+            return tss_map_to_js_val(ctx, phdr.tss_map);
+          case Property::UnprotectedX5chain:
+            return x5chain_to_js_val(ctx, uhdr.x5chain.value());
+          case Property::Measurement:
+            return ctx.new_string(details->get_measurement().hex_str());
+          case Property::ReportData:
+            return ctx.new_string(details->get_report_data().hex_str());
+          case Property::HostData:
+            return ctx.new_string(ccf::ds::to_hex(details->get_host_data()));
+          case Property::UvmEndorsements:
+          {
+            const auto& uvm_endorsements =
+              details->get_uvm_endorsements().value();
+            auto uvm_obj = ctx.new_obj();
+            uvm_obj.set("did", ctx.new_string(uvm_endorsements.did));
+            uvm_obj.set("feed", ctx.new_string(uvm_endorsements.feed));
+            uvm_obj.set("svn", ctx.new_string(uvm_endorsements.svn));
+            return uvm_obj;
+          }
+          case Property::ReportedTcb:
+          {
+            auto reported_tcb = ctx.new_obj();
+            const auto& tcb = details->get_tcb_version_policy();
+            if (tcb.microcode.has_value())
+            {
+              reported_tcb.set_uint32("microcode", tcb.microcode.value());
+            }
+            if (tcb.snp.has_value())
+            {
+              reported_tcb.set_uint32("snp", tcb.snp.value());
+            }
+            if (tcb.tee.has_value())
+            {
+              reported_tcb.set_uint32("tee", tcb.tee.value());
+            }
+            if (tcb.boot_loader.has_value())
+            {
+              reported_tcb.set_uint32("boot_loader", tcb.boot_loader.value());
+            }
+            if (tcb.fmc.has_value())
+            {
+              reported_tcb.set_uint32("fmc", tcb.fmc.value());
+            }
+            if (tcb.hexstring.has_value())
+            {
+              reported_tcb.set(
+                "hexstring", ctx.new_string(tcb.hexstring.value()));
+            }
+            return reported_tcb;
+          }
+          case Property::ProductName:
+            return ctx.new_string(
+              ccf::pal::snp::to_string(details->get_product_name()));
+          default:
+            throw std::logic_error("Unknown lazy property");
+        }
+      }
+      // NOLINTEND(bugprone-unchecked-optional-access)
+
+      static JSValue get(
+        JSContext* ctx,
+        JSValueConst this_val,
+        int /* argc */,
+        JSValueConst* /* argv */,
+        int magic,
+        JSValue* func_data)
+      {
+        auto* self =
+          static_cast<LazyProperties*>(JS_GetOpaque(func_data[0], class_id()));
+        if (self == nullptr)
+        {
+          return JS_ThrowTypeError(
+            ctx, "Policy arguments can only be read while applying the policy");
+        }
+
+        const auto property = static_cast<Property>(magic);
+        try
+        {
+          auto value = self->convert(property);
+          // Replace the getter by the converted value, so that it is only
+          // converted once.
+          JS_DefinePropertyValueStr(
+            ctx,
+            this_val,
+            name(property),
+            JS_DupValue(ctx, value.val),
+            JS_PROP_C_W_E);
+          return JS_DupValue(ctx, value.val);
+        }
+        catch (const std::exception& e)
+        {
+          return JS_ThrowInternalError(
+            ctx, "Failed to read %s: %s", name(property), e.what());
+        }
+      }
+    };
+
     static inline ccf::js::core::JSWrappedValue protected_header_to_js_val(
-      ccf::js::core::Context& ctx, const scitt::cose::ProtectedHeader& phdr)
+      ccf::js::core::Context& ctx,
+      const scitt::cose::ProtectedHeader& phdr,
+      LazyProperties& lazy)
     {
       auto obj = ctx.new_obj();
 
@@ -93,16 +423,7 @@ namespace scitt
 
         if (phdr.x5chain.has_value())
         {
-          auto x5_array = ctx.new_array();
-          size_t i = 0;
-
-          for (const auto& der_cert : phdr.x5chain.value())
-          {
-            auto pem = ccf::crypto::cert_der_to_pem(der_cert);
-            x5_array.set_at_index(i++, ctx.new_string(pem.str()));
-          }
-
-          obj.set("x5chain", std::move(x5_array));
+          lazy.define(obj, LazyProperties::Property::ProtectedX5chain);
         }
 
         auto cwt = ctx.new_obj();
@@ -124,105 +445,22 @@ namespace scitt
         }
         obj.set("cwt", std::move(cwt));
 
-        auto tss_map = ctx.new_obj();
-        if (phdr.tss_map.svc_id.has_value())
-        {
-          tss_map.set("svc_id", ctx.new_string(phdr.tss_map.svc_id.value()));
-        }
-        if (phdr.tss_map.attestation.has_value())
-        {
-          tss_map.set(
-            "attestation",
-            ctx.new_array_buffer_copy(phdr.tss_map.attestation.value()));
-        }
-        if (phdr.tss_map.attestation_type.has_value())
-        {
-          tss_map.set(
-            "attestation_type",
-            ctx.new_string(phdr.tss_map.attestation_type.value()));
-        }
-        if (phdr.tss_map.cose_key.has_value())
-        {
-          auto cose_key = phdr.tss_map.cose_key.value();
-          auto cose_key_obj = ctx.new_obj();
-
-          if (cose_key.kty().has_value())
-          {
-            cose_key_obj.set_int64("kty", cose_key.kty().value());
-          }
-          if (cose_key.crv_n_k_pub().has_value())
-          {
-            if (std::holds_alternative<int64_t>(cose_key.crv_n_k_pub().value()))
-            {
-              cose_key_obj.set_int64(
-                "crv", std::get<int64_t>(cose_key.crv_n_k_pub().value()));
-            }
-            else if (std::holds_alternative<std::vector<uint8_t>>(
-                       cose_key.crv_n_k_pub().value()))
-            {
-              cose_key_obj.set(
-                "n",
-                ctx.new_array_buffer_copy(std::get<std::vector<uint8_t>>(
-                  cose_key.crv_n_k_pub().value())));
-            }
-          }
-          if (cose_key.x_e().has_value())
-          {
-            cose_key_obj.set(
-              "x_e", ctx.new_array_buffer_copy(cose_key.x_e().value()));
-          }
-          if (cose_key.y().has_value())
-          {
-            cose_key_obj.set(
-              "y", ctx.new_array_buffer_copy(cose_key.y().value()));
-          }
-
-          tss_map.set("cose_key", std::move(cose_key_obj));
-
-          auto cose_key_sha256 = cose_key.to_sha256_thumb();
-          tss_map.set(
-            "cose_key_sha256",
-            ctx.new_string(ccf::ds::to_hex(cose_key_sha256)));
-        }
-        if (phdr.tss_map.snp_endorsements.has_value())
-        {
-          tss_map.set(
-            "snp_endorsements",
-            ctx.new_array_buffer_copy(phdr.tss_map.snp_endorsements.value()));
-        }
-        if (phdr.tss_map.uvm_endorsements.has_value())
-        {
-          tss_map.set(
-            "uvm_endorsements",
-            ctx.new_array_buffer_copy(phdr.tss_map.uvm_endorsements.value()));
-        }
-        if (phdr.tss_map.ver.has_value())
-        {
-          tss_map.set_int64("ver", phdr.tss_map.ver.value());
-        }
-        obj.set("attestedsvc", std::move(tss_map));
+        lazy.define(obj, LazyProperties::Property::Attestedsvc);
       }
 
       return obj;
     }
 
     static inline ccf::js::core::JSWrappedValue unprotected_header_to_js_val(
-      ccf::js::core::Context& ctx, const scitt::cose::UnprotectedHeader uhdr)
+      ccf::js::core::Context& ctx,
+      const scitt::cose::UnprotectedHeader& uhdr,
+      LazyProperties& lazy)
     {
       auto obj = ctx.new_obj();
 
       if (uhdr.x5chain.has_value())
       {
-        auto x5_array = ctx.new_array();
-        size_t i = 0;
-
-        for (const auto& der_cert : uhdr.x5chain.value())
-        {
-          auto pem = ccf::crypto::cert_der_to_pem(der_cert);
-          x5_array.set_at_index(i++, ctx.new_string(pem.str()));
-        }
-
-        obj.set("x5chain", std::move(x5_array));
+        lazy.define(obj, LazyProperties::Property::UnprotectedX5chain);
       }
 
       return obj;
@@ -230,65 +468,75 @@ namespace scitt
 
     static inline ccf::js::core::JSWrappedValue verified_details_to_js_val(
       ccf::js::core::Context& ctx,
-      const std::optional<verifier::VerifiedSevSnpAttestationDetails>& details)
+      const Details& details,
+      LazyProperties& lazy)
     {
+      using Property = LazyProperties::Property;
       auto obj = ctx.new_obj();
 
       if (details.has_value())
       {
-        const auto& measurement = details->get_measurement();
-        obj.set("measurement", ctx.new_string(measurement.hex_str()));
-        const auto& report_data = details->get_report_data();
-        obj.set("report_data", ctx.new_string(report_data.hex_str()));
-        auto host_data_str = ccf::ds::to_hex(details->get_host_data());
-        obj.set("host_data", ctx.new_string(host_data_str));
+        lazy.define(obj, Property::Measurement);
+        lazy.define(obj, Property::ReportData);
+        lazy.define(obj, Property::HostData);
         if (details->get_uvm_endorsements().has_value())
         {
-          const auto& uvm_endorsements =
-            details->get_uvm_endorsements().value();
-          auto uvm_obj = ctx.new_obj();
-          uvm_obj.set("did", ctx.new_string(uvm_endorsements.did));
-          uvm_obj.set("feed", ctx.new_string(uvm_endorsements.feed));
-          uvm_obj.set("svn", ctx.new_string(uvm_endorsements.svn));
-          obj.set("uvm_endorsements", std::move(uvm_obj));
-        }
-
-        auto reported_tcb = ctx.new_obj();
-        const auto& tcb = details->get_tcb_version_policy();
-        if (tcb.microcode.has_value())
-        {
-          reported_tcb.set_uint32("microcode", tcb.microcode.value());
-        }
-        if (tcb.snp.has_value())
-        {
-          reported_tcb.set_uint32("snp", tcb.snp.value());
-        }
-        if (tcb.tee.has_value())
-        {
-          reported_tcb.set_uint32("tee", tcb.tee.value());
-        }
-        if (tcb.boot_loader.has_value())
-        {
-          reported_tcb.set_uint32("boot_loader", tcb.boot_loader.value());
-        }
-        if (tcb.fmc.has_value())
-        {
-          reported_tcb.set_uint32("fmc", tcb.fmc.value());
+          lazy.define(obj, Property::UvmEndorsements);
         }
-        if (tcb.hexstring.has_value())
-        {
-          reported_tcb.set("hexstring", ctx.new_string(tcb.hexstring.value()));
-        }
-        obj.set("reported_tcb", std::move(reported_tcb));
-        obj.set(
-          "product_name",
-          ctx.new_string(
-            ccf::pal::snp::to_string(details->get_product_name())));
+        lazy.define(obj, Property::ReportedTcb);
+        lazy.define(obj, Property::ProductName);
       }
 
       return obj;
     }
 
+    /**
+     * An ArrayBuffer referring to memory owned by the caller, rather than to
+     * a copy of it in the JS heap. QuickJS has no read-only ArrayBuffers, so
+     * scripts can write to that memory. It is detached when this object is
+     * destroyed, after which it appears empty to any JS value still holding
+     * it.
+     */
+    class ExternalArrayBuffer
+    {
+    public:
+      ExternalArrayBuffer(
+        ccf::js::core::Context& ctx, std::span<uint8_t> data) :
+        ctx(ctx),
+        value(
+          ctx,
+          JS_NewArrayBuffer(
+            ctx, data.data(), data.size(), &keep_data, nullptr, false))
+      {}
+
+      ExternalArrayBuffer(const ExternalArrayBuffer&) = delete;
+      ExternalArrayBuffer& operator=(const ExternalArrayBuffer&) = delete;
+
+      ~ExternalArrayBuffer()
+      {
+        JS_DetachArrayBuffer(ctx, value.val);
+      }
+
+      const ccf::js::core::JSWrappedValue& get() const
+      {
+        return value;
+      }
+
+    private:
+      ccf::js::core::Context& ctx;
+      ccf::js::core::JSWrappedValue value;
+
+      // The data is owned by the caller, and must not be freed by QuickJS.
+      static void keep_data(
+        JSRuntime* /* rt */, void* /* opaque */, void* /* ptr */)
+      {}
+    };
+
+    /**
+     * Run a policy script. The payload is passed to it without being copied,
+     * so the script can write to it: the caller must not use it for anything
+     * but the policy afterwards.
+     */
     static inline std::optional<std::string> apply_js_policy(
       const PolicyScript& script,
       const std::string& policy_name,
@@ -314,14 +562,20 @@ namespace scitt
           fmt::format("Invalid policy module: {}", e.what()));
       }
 
-      auto phdr_val = protected_header_to_js_val(interpreter, phdr);
-      auto uhdr_val = unprotected_header_to_js_val(interpreter, uhdr);
-      auto payload_val = interpreter.new_array_buffer_copy(payload);
-      auto details_val = verified_details_to_js_val(interpreter, details);
+      // Declared after the interpreter, so that the lazy properties and the
+      // payload are detached before it is destroyed.
+      LazyProperties lazy(interpreter, phdr, uhdr, details);
+      auto phdr_val = protected_header_to_js_val(interpreter, phdr, lazy);
+      auto uhdr_val = unprotected_header_to_js_val(interpreter, uhdr, lazy);
+      auto details_val = verified_details_to_js_val(interpreter, details, lazy);
+
+      // The payload can be as large as the request, so it is not copied, and
+      // doesn't count towards max_heap_bytes.
+      ExternalArrayBuffer payload_val(interpreter, payload);
 
       const auto result = interpreter.call_with_rt_options(
         apply_func,
-        {phdr_val, uhdr_val, payload_val, details_val},
+        {phdr_val, uhdr_val, payload_val.get(), details_val},
         ccf::JSRuntimeOptions{
           10 * 1024 * 1024, // max_heap_bytes (10MB)
           1024 * 1024, // max_stack_bytes (1MB)
@@ -367,16 +621,91 @@ namespace scitt
 
   // Returns nullopt for success, else a string describing why the policy was
   // refused. May also throw if given invalid policies, or policy execution
-  // throws.
+  // throws. If a cache is given, the policy must not depend on the payload,
+  // which it is given empty, and its verdicts are reused for identical
+  // headers. Errors are not cached.
   static inline std::optional<std::string> check_for_policy_violations(
     const PolicyScript& script,
     const std::string& policy_name,
     const cose::ProtectedHeader& phdr,
     const cose::UnprotectedHeader& uhdr,
     std::span<uint8_t> payload,
+    const std::optional<verifier::VerifiedSevSnpAttestationDetails>& details,
+    PolicyVerdictCache* cache = nullptr)
+  {
+    static auto& evaluations = metrics::registry().counter(
+      "scitt_policy_evaluations_total", "Number of policy evaluations");
+    static auto& violations = metrics::registry().counter(
+      "scitt_policy_violations_total",
+      "Number of policy evaluations which refused a signed statement");
+    static auto& failures = metrics::registry().counter(
+      "scitt_policy_failures_total",
+      "Number of policy evaluations which failed with an error");
+
+    static auto& cache_hits = metrics::registry().counter(
+      "scitt_policy_cache_hits_total",
+      "Number of policy evaluations whose verdict was cached");
+
+    std::optional<PolicyVerdictCache::Key> key;
+    if (cache != nullptr)
+    {
+      key = PolicyVerdictCache::make_key(script, phdr, uhdr, details);
+    }
+    if (key.has_value())
+    {
+      if (auto verdict = cache->find(key.value()))
+      {
+        cache_hits.increment();
+        return verdict.value();
+      }
+    }
+
+    evaluations.increment();
+    try
+    {
+      auto result = js::apply_js_policy(
+        script,
+        policy_name,
+        phdr,
+        uhdr,
+        cache != nullptr ? std::span<uint8_t>() : payload,
+        details);
+      if (result.has_value())
+      {
+        violations.increment();
+      }
+      if (key.has_value())
+      {
+        cache->insert(key.value(), result);
+      }
+      return result;
+    }
+    catch (...)
+    {
+      failures.increment();
+      throw;
+    }
+  }
+
+  // Returns nullopt if all rules are met, else the reason of the first rule
+  // which is not.
+  static inline std::optional<std::string> check_for_rule_violations(
+    const CompiledPolicyRules& rules,
+    const cose::ProtectedHeader& phdr,
     const std::optional<verifier::VerifiedSevSnpAttestationDetails>& details)
   {
-    return js::apply_js_policy(
-      script, policy_name, phdr, uhdr, payload, details);
+    static auto& evaluations = metrics::registry().counter(
+      "scitt_policy_evaluations_total", "Number of policy evaluations");
+    static auto& violations = metrics::registry().counter(
+      "scitt_policy_violations_total",
+      "Number of policy evaluations which refused a signed statement");
+
+    evaluations.increment();
+    auto result = rules.evaluate(phdr, details);
+    if (result.has_value())
+    {
+      violations.increment();
+    }
+    return result;
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,475 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "cose.h"
+#include "verified_details.h"
+
+#include <algorithm>
+#include <ccf/ds/hex.h>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace scitt
+{
+  /**
+   * A declarative policy rule, comparing a field of a signed statement to a
+   * constant. Fields are named after the arguments of a policy script, e.g.
+   * "phdr.cwt.iss" or "details.host_data".
+   */
+  struct PolicyRule
+  {
+    std::string field;
+
+    /**
+     * One of "==", "!=", "<", "<=", ">", ">=", "startsWith" or "in".
+     */
+    std::string op;
+
+    /**
+     * An integer or a string, matching the type of the field. For "in", an
+     * array of those.
+     */
+    nlohmann::json value;
+
+    /**
+     * Reason given when the rule is not met. Defaults to the rule itself.
+     */
+    std::optional<std::string> reason;
+
+    bool operator==(const PolicyRule& other) const = default;
+  };
+
+  namespace rules
+  {
+    using Value = std::variant<int64_t, std::string>;
+    using Details = std::optional<verifier::VerifiedSevSnpAttestationDetails>;
+    using Getter = std::optional<Value> (*)(
+      const cose::ProtectedHeader& phdr, const Details& details);
+
+    enum class Type
+    {
+      Integer,
+      String,
+      // Either, depending on the signed statement (e.g. cty)
+      Any,
+    };
+
+    struct Field
+    {
+      std::string_view name;
+      Type type;
+      Getter get;
+    };
+
+    template <typename T>
+    static std::optional<Value> value_of(const std::optional<T>& value)
+    {
+      if (!value.has_value())
+      {
+        return std::nullopt;
+      }
+      if constexpr (std::is_same_v<T, std::string>)
+      {
+        return Value(value.value());
+      }
+      else
+      {
+        return Value(static_cast<int64_t>(value.value()));
+      }
+    }
+
+    // NOLINTBEGIN(bugprone-unchecked-optional-access)
+    // The fields exposed to policy scripts by protected_header_to_js_val and
+    // verified_details_to_js_val, except for binary and array values.
+    static const std::vector<Field>& fields()
+    {
+      using P = const cose::ProtectedHeader&;
+      using D = const Details&;
+      static const std::vector<Field> instance = {
+        {"phdr.alg",
+         Type::Integer,
+         [](P p, D) { return value_of(p.alg); }},
+        {"phdr.kid", Type::String, [](P p, D) { return value_of(p.kid); }},
+        {"phdr.issuer",
+         Type::String,
+         [](P p, D) { return value_of(p.issuer); }},
+        {"phdr.feed", Type::String, [](P p, D) { return value_of(p.feed); }},
+        {"phdr.iat", Type::Integer, [](P p, D) { return value_of(p.iat); }},
+        {"phdr.svn", Type::Integer, [](P p, D) { return value_of(p.svn); }},
+        {"phdr.cty",
+         Type::Any,
+         [](P p, D) -> std::optional<Value> {
+           if (!p.cty.has_value())
+           {
+             return std::nullopt;
+           }
+           return std::visit(
+             [](const auto& cty) { return Value(cty); }, p.cty.value());
+         }},
+        {"phdr.cwt.iss",
+         Type::String,
+         [](P p, D) { return value_of(p.cwt_claims.iss); }},
+        {"phdr.cwt.sub",
+         Type::String,
+         [](P p, D) { return value_of(p.cwt_claims.sub); }},
+        {"phdr.cwt.iat",
+         Type::Integer,
+         [](P p, D) { return value_of(p.cwt_claims.iat); }},
+        {"phdr.cwt.svn",
+         Type::Integer,
+         [](P p, D) { return value_of(p.cwt_claims.svn); }},
+        {"phdr.attestedsvc.svc_id",
+         Type::String,
+         [](P p, D) { return value_of(p.tss_map.svc_id); }},
+        {"phdr.attestedsvc.attestation_type",
+         Type::String,
+         [](P p, D) { return value_of(p.tss_map.attestation_type); }},
+        {"phdr.attestedsvc.ver",
+         Type::Integer,
+         [](P p, D) { return value_of(p.tss_map.ver); }},
+        {"phdr.attestedsvc.cose_key_sha256",
+         Type::String,
+         [](P p, D) -> std::optional<Value> {
+           if (!p.tss_map.cose_key.has_value())
+           {
+             return std::nullopt;
+           }
+           return ccf::ds::to_hex(p.tss_map.cose_key->to_sha256_thumb());
+         }},
+        {"details.measurement",
+         Type::String,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return d->get_measurement().hex_str();
+         }},
+        {"details.report_data",
+         Type::String,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return d->get_report_data().hex_str();
+         }},
+        {"details.host_data",
+         Type::String,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return ccf::ds::to_hex(d->get_host_data());
+         }},
+        {"details.uvm_endorsements.did",
+         Type::String,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value() || !d->get_uvm_endorsements().has_value())
+           {
+             return std::nullopt;
+           }
+           return d->get_uvm_endorsements()->did;
+         }},
+        {"details.uvm_endorsements.feed",
+         Type::String,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value() || !d->get_uvm_endorsements().has_value())
+           {
+             return std::nullopt;
+           }
+           return d->get_uvm_endorsements()->feed;
+         }},
+        {"details.uvm_endorsements.svn",
+         Type::String,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value() || !d->get_uvm_endorsements().has_value())
+           {
+             return std::nullopt;
+           }
+           return d->get_uvm_endorsements()->svn;
+         }},
+        {"details.reported_tcb.microcode",
+         Type::Integer,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return value_of(d->get_tcb_version_policy().microcode);
+         }},
+        {"details.reported_tcb.snp",
+         Type::Integer,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return value_of(d->get_tcb_version_policy().snp);
+         }},
+        {"details.reported_tcb.tee",
+         Type::Integer,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return value_of(d->get_tcb_version_policy().tee);
+         }},
+        {"details.reported_tcb.boot_loader",
+         Type::Integer,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return value_of(d->get_tcb_version_policy().boot_loader);
+         }},
+        {"details.reported_tcb.fmc",
+         Type::Integer,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return value_of(d->get_tcb_version_policy().fmc);
+         }},
+        {"details.reported_tcb.hexstring",
+         Type::String,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return value_of(d->get_tcb_version_policy().hexstring);
+         }},
+        {"details.product_name",
+         Type::String,
+         [](P, D d) -> std::optional<Value> {
+           if (!d.has_value())
+           {
+             return std::nullopt;
+           }
+           return ccf::pal::snp::to_string(d->get_product_name());
+         }},
+      };
+      return instance;
+    }
+    // NOLINTEND(bugprone-unchecked-optional-access)
+
+    enum class Op
+    {
+      Equal,
+      NotEqual,
+      Less,
+      LessOrEqual,
+      Greater,
+      GreaterOrEqual,
+      StartsWith,
+      In,
+    };
+
+    static Op parse_op(const std::string& op)
+    {
+      static const std::vector<std::pair<std::string_view, Op>> ops = {
+        {"==", Op::Equal},
+        {"!=", Op::NotEqual},
+        {"<", Op::Less},
+        {"<=", Op::LessOrEqual},
+        {">", Op::Greater},
+        {">=", Op::GreaterOrEqual},
+        {"startsWith", Op::StartsWith},
+        {"in", Op::In},
+      };
+      for (const auto& [name, value] : ops)
+      {
+        if (name == op)
+        {
+          return value;
+        }
+      }
+      throw std::invalid_argument(fmt::format("unknown operator '{}'", op));
+    }
+
+    static Value parse_value(const nlohmann::json& value, Type type)
+    {
+      if (value.is_number_integer() && type != Type::String)
+      {
+        return value.get<int64_t>();
+      }
+      if (value.is_string() && type != Type::Integer)
+      {
+        return value.get<std::string>();
+      }
+      throw std::invalid_argument(fmt::format(
+        "expected {} value, got {}",
+        type == Type::Integer ? "an integer" :
+          type == Type::String ? "a string" :
+                                 "an integer or string",
+        value.dump()));
+    }
+  }
+
+  /**
+   * A list of policy rules compiled into native predicates, so that a signed
+   * statement can be checked against them without running a JS interpreter.
+   * All rules must be met for a signed statement to be accepted.
+   */
+  class CompiledPolicyRules
+  {
+  public:
+    CompiledPolicyRules() = default;
+
+    /**
+     * Compile a list of rules. Throws std::invalid_argument if a rule refers
+     * to an unknown field or operator, or its value has the wrong type.
+     */
+    static CompiledPolicyRules compile(const std::vector<PolicyRule>& rules)
+    {
+      CompiledPolicyRules compiled;
+      compiled.predicates.reserve(rules.size());
+      for (size_t i = 0; i < rules.size(); i++)
+      {
+        try
+        {
+          compiled.predicates.push_back(compile_rule(rules[i]));
+        }
+        catch (const std::exception& e)
+        {
+          throw std::invalid_argument(
+            fmt::format("Rule {} ({}): {}", i, rules[i].field, e.what()));
+        }
+      }
+      return compiled;
+    }
+
+    /**
+     * Returns std::nullopt if all rules are met, or otherwise the reason of
+     * the first rule which is not. A rule is never met if its field is
+     * absent from the signed statement, whatever its operator.
+     */
+    std::optional<std::string> evaluate(
+      const cose::ProtectedHeader& phdr, const rules::Details& details) const
+    {
+      for (const auto& predicate : predicates)
+      {
+        auto actual = predicate.get(phdr, details);
+        if (!actual.has_value() || !predicate.matches(actual.value()))
+        {
+          return predicate.reason;
+        }
+      }
+      return std::nullopt;
+    }
+
+    size_t size() const
+    {
+      return predicates.size();
+    }
+
+  private:
+    struct Predicate
+    {
+      rules::Getter get;
+      rules::Op op;
+      std::vector<rules::Value> values;
+      std::string reason;
+
+      bool matches(const rules::Value& actual) const
+      {
+        using rules::Op;
+        if (op == Op::In)
+        {
+          return std::find(values.begin(), values.end(), actual) !=
+            values.end();
+        }
+
+        const auto& expected = values.front();
+        if (actual.index() != expected.index())
+        {
+          // Only possible for fields of either type, such as cty
+          return op == Op::NotEqual;
+        }
+
+        switch (op)
+        {
+          case Op::Equal:
+            return actual == expected;
+          case Op::NotEqual:
+            return actual != expected;
+          case Op::Less:
+            return actual < expected;
+          case Op::LessOrEqual:
+            return actual <= expected;
+          case Op::Greater:
+            return actual > expected;
+          case Op::GreaterOrEqual:
+            return actual >= expected;
+          case Op::StartsWith:
+            return std::get<std::string>(actual).starts_with(
+              std::get<std::string>(expected));
+          default:
+            return false;
+        }
+      }
+    };
+
+    std::vector<Predicate> predicates;
+
+    static Predicate compile_rule(const PolicyRule& rule)
+    {
+      const auto& fields = rules::fields();
+      auto field = std::find_if(
+        fields.begin(), fields.end(), [&](const rules::Field& f) {
+          return f.name == rule.field;
+        });
+      if (field == fields.end())
+      {
+        throw std::invalid_argument("unknown field");
+      }
+
+      Predicate predicate{
+        .get = field->get,
+        .op = rules::parse_op(rule.op),
+        .values = {},
+        .reason = rule.reason.value_or(fmt::format(
+          "Rule not met: {} {} {}", rule.field, rule.op, rule.value.dump()))};
+
+      if (predicate.op == rules::Op::In)
+      {
+        if (!rule.value.is_array() || rule.value.empty())
+        {
+          throw std::invalid_argument("expected a non-empty array value");
+        }
+        for (const auto& value : rule.value)
+        {
+          predicate.values.push_back(rules::parse_value(value, field->type));
+        }
+      }
+      else
+      {
+        auto type = field->type;
+        if (predicate.op == rules::Op::StartsWith)
+        {
+          if (type == rules::Type::Integer)
+          {
+            throw std::invalid_argument("startsWith requires a string field");
+          }
+          type = rules::Type::String;
+        }
+        predicate.values.push_back(rules::parse_value(rule.value, type));
+      }
+
+      return predicate;
+    }
+  };
+}
@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "kv_types.h"
+#include "policy_rules.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace scitt
+{
+  /**
+   * The policies of the service configuration, with their rules compiled,
+   * indexed by the issuer prefixes they are routed to.
+   */
+  class PolicyTable
+  {
+  public:
+    struct Entry
+    {
+      // Name of the policy, used to report errors in its script
+      std::string name;
+      std::optional<CompiledPolicyRules> rules;
+      std::optional<PolicyScript> script;
+
+      bool empty() const
+      {
+        return !rules.has_value() && !script.has_value();
+      }
+    };
+
+    /**
+     * Compile the policies of the configuration. Throws std::invalid_argument
+     * if any of their rules is invalid.
+     */
+    static PolicyTable compile(const Configuration::Policy& policy)
+    {
+      PolicyTable table;
+      table.fallback = make_entry(
+        "configured_policy", policy.policy_rules, policy.policy_script);
+
+      for (const auto& route : policy.policy_routes.value_or(
+             std::vector<Configuration::Policy::Route>{}))
+      {
+        try
+        {
+          table.routes.push_back(
+            {route.issuer_prefix,
+             make_entry(
+               fmt::format("configured_policy[{}]", route.issuer_prefix),
+               route.policy_rules,
+               route.policy_script)});
+        }
+        catch (const std::invalid_argument& e)
+        {
+          throw std::invalid_argument(fmt::format(
+            "Route for issuer prefix {}: {}", route.issuer_prefix, e.what()));
+        }
+      }
+
+      // Longest prefixes first, so that the first match is the longest one.
+      std::stable_sort(
+        table.routes.begin(),
+        table.routes.end(),
+        [](const auto& a, const auto& b) {
+          return a.issuer_prefix.size() > b.issuer_prefix.size();
+        });
+
+      return table;
+    }
+
+    /**
+     * Select the policy of the route with the longest issuer prefix matching
+     * the given issuer, or the policy set outside of any route if none does.
+     */
+    const Entry& select(const std::optional<std::string>& issuer) const
+    {
+      if (issuer.has_value())
+      {
+        for (const auto& route : routes)
+        {
+          if (issuer->starts_with(route.issuer_prefix))
+          {
+            return route.policy;
+          }
+        }
+      }
+      return fallback;
+    }
+
+  private:
+    struct Route
+    {
+      std::string issuer_prefix;
+      Entry policy;
+    };
+
+    std::vector<Route> routes;
+    Entry fallback;
+
+    static Entry make_entry(
+      std::string name,
+      const std::optional<std::vector<PolicyRule>>& rules,
+      const std::optional<PolicyScript>& script)
+    {
+      Entry entry{.name = std::move(name), .rules = {}, .script = script};
+      if (rules.has_value())
+      {
+        entry.rules = CompiledPolicyRules::compile(rules.value());
+      }
+      return entry;
+    }
+  };
+}
@@ -0,0 +1,148 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "cose.h"
+#include "historical/lru.h"
+#include "verified_details.h"
+
+#include <array>
+#include <ccf/crypto/sha256_hash.h>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace scitt
+{
+  /**
+   * A cache of the verdicts of a policy script, for scripts which only
+   * depend on the headers and attestation details of a signed statement,
+   * and not on its payload or on the current time. Signed statements from
+   * the same issuer usually share the same headers, so their verdict only
+   * needs to be computed once.
+   *
+   * Verdicts are keyed by a digest of the script and of all the arguments
+   * passed to it except for the payload. The cache is cleared when the
+   * configuration changes.
+   */
+  class PolicyVerdictCache
+  {
+  public:
+    using Key = ccf::crypto::Sha256Hash::Representation;
+
+    // std::nullopt if the policy was met, or otherwise the reason it was not
+    using Verdict = std::optional<std::string>;
+
+    /**
+     * Resize the cache, and clear it if the given configuration version is
+     * not the one it was last configured with.
+     */
+    void configure(std::optional<uint64_t> version, size_t max_entries)
+    {
+      std::lock_guard guard(lock);
+      if (version != configuration_version)
+      {
+        configuration_version = version;
+        verdicts.clear();
+      }
+      verdicts.set_max_size(max_entries);
+    }
+
+    std::optional<Verdict> find(const Key& key)
+    {
+      std::lock_guard guard(lock);
+      auto it = verdicts.find(key);
+      if (it == verdicts.end())
+      {
+        return std::nullopt;
+      }
+      auto verdict = it->second;
+      // Inserting an existing key only marks it as recently used.
+      verdicts.insert(key, Verdict(verdict));
+      return verdict;
+    }
+
+    void insert(const Key& key, Verdict verdict)
+    {
+      std::lock_guard guard(lock);
+      verdicts.insert(key, std::move(verdict));
+    }
+
+    /**
+     * Compute the cache key of a policy evaluation. Returns std::nullopt if
+     * the protected header was not decoded from an encoded signed statement,
+     * in which case the verdict cannot be cached.
+     */
+    static std::optional<Key> make_key(
+      const std::string& script,
+      const cose::ProtectedHeader& phdr,
+      const cose::UnprotectedHeader& uhdr,
+      const std::optional<verifier::VerifiedSevSnpAttestationDetails>& details)
+    {
+      if (phdr.encoded.empty())
+      {
+        return std::nullopt;
+      }
+
+      // Each value is prefixed by its length, and each list by its number of
+      // values, so that the concatenation is unambiguous.
+      std::vector<uint8_t> input;
+      const auto append_size = [&input](uint64_t size) {
+        const auto* size_bytes = reinterpret_cast<const uint8_t*>(&size);
+        input.insert(input.end(), size_bytes, size_bytes + sizeof(size));
+      };
+      const auto append = [&](std::span<const uint8_t> value) {
+        append_size(value.size());
+        input.insert(input.end(), value.begin(), value.end());
+      };
+      const auto append_str = [&append](const std::string& value) {
+        append(
+          {reinterpret_cast<const uint8_t*>(value.data()), value.size()});
+      };
+
+      append_str(script);
+      append(phdr.encoded);
+      const auto& x5chain = uhdr.x5chain.value_or(
+        std::vector<std::vector<uint8_t>>{});
+      append_size(x5chain.size());
+      for (const auto& cert : x5chain)
+      {
+        append(cert);
+      }
+
+      // The details are derived from the attestation in the protected
+      // header, but are included in case their derivation changes.
+      append_size(details.has_value() ? 1 : 0);
+      if (details.has_value())
+      {
+        append_str(details->get_measurement().hex_str());
+        append_str(details->get_report_data().hex_str());
+        append(details->get_host_data());
+        const auto& uvm_endorsements = details->get_uvm_endorsements();
+        append_size(uvm_endorsements.has_value() ? 1 : 0);
+        if (uvm_endorsements.has_value())
+        {
+          append_str(uvm_endorsements->did);
+          append_str(uvm_endorsements->feed);
+          append_str(uvm_endorsements->svn);
+        }
+        append_str(
+          details->get_tcb_version_policy().hexstring.value_or(std::string()));
+        append_str(ccf::pal::snp::to_string(details->get_product_name()));
+      }
+
+      return ccf::crypto::Sha256Hash(input).h;
+    }
+
+  private:
+    static constexpr size_t DEFAULT_MAX_ENTRIES = 0;
+
+    std::mutex lock;
+    std::optional<uint64_t> configuration_version;
+    LRU<Key, Verdict> verdicts{DEFAULT_MAX_ENTRIES};
+  };
+}
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "historical/lru.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace scitt
+{
+  /**
+   * A limit on the rate at which requests sharing a key are admitted.
+   */
+  struct RateLimit
+  {
+    /**
+     * Sustained number of requests admitted per second.
+     */
+    double rate_per_second = 0;
+
+    /**
+     * Number of requests which may be admitted at once after a quiet period.
+     */
+    double burst = 1;
+
+    bool operator==(const RateLimit& other) const = default;
+  };
+
+  /**
+   * A set of token buckets, one per key.
+   *
+   * Each bucket holds up to `burst` tokens and is refilled continuously at
+   * `rate_per_second`. A request is admitted if a whole token is available.
+   *
+   * Buckets are only created for keys which send requests, and only the most
+   * recently used ones are kept. A bucket which is evicted and later created
+   * again starts full, which errs on the side of admitting requests.
+   */
+  class TokenBuckets
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DEFAULT_MAX_BUCKETS = 10000;
+
+    explicit TokenBuckets(size_t max_buckets = DEFAULT_MAX_BUCKETS) :
+      buckets(max_buckets)
+    {}
+
+    /**
+     * Take a token from the bucket of the given key. Returns std::nullopt if
+     * the request is admitted, or otherwise how long to wait until a token
+     * is available.
+     *
+     * The limit is passed on every call, rather than stored with the bucket,
+     * so that configuration changes apply immediately.
+     */
+    std::optional<std::chrono::duration<double>> try_acquire(
+      const std::string& key,
+      const RateLimit& limit,
+      Clock::time_point now = Clock::now())
+    {
+      const double capacity = std::max(limit.burst, 1.0);
+
+      std::lock_guard guard(lock);
+      auto it = buckets.find(key);
+      if (it == buckets.end())
+      {
+        it = buckets.insert(key, Bucket{capacity, now});
+      }
+      else
+      {
+        // Inserting an existing key only marks it as recently used.
+        it = buckets.insert(key, Bucket{});
+      }
+
+      auto& bucket = it->second;
+      const std::chrono::duration<double> elapsed = now - bucket.updated;
+      if (elapsed.count() > 0)
+      {
+        bucket.tokens = std::min(
+          capacity, bucket.tokens + elapsed.count() * limit.rate_per_second);
+        bucket.updated = now;
+      }
+      else
+      {
+        // A smaller bucket may have been configured since the last request.
+        bucket.tokens = std::min(capacity, bucket.tokens);
+      }
+
+      if (bucket.tokens >= 1)
+      {
+        bucket.tokens -= 1;
+        return std::nullopt;
+      }
+
+      if (limit.rate_per_second <= 0)
+      {
+        return std::chrono::duration<double>::max();
+      }
+      return std::chrono::duration<double>(
+        (1 - bucket.tokens) / limit.rate_per_second);
+    }
+
+  private:
+    struct Bucket
+    {
+      double tokens = 0;
+      Clock::time_point updated;
+    };
+
+    std::mutex lock;
+    LRU<std::string, Bucket> buckets;
+  };
+
+  /**
+   * Convert a wait duration to the value of a Retry-After header, in whole
+   * seconds, rounding up. Waits are capped, since the configured limits may
+   * change in the meantime.
+   */
+  static uint32_t retry_after_seconds(std::chrono::duration<double> wait)
+  {
+    static constexpr double MAX_RETRY_AFTER_SECONDS = 3600;
+    return static_cast<uint32_t>(
+      std::clamp(std::ceil(wait.count()), 1.0, MAX_RETRY_AFTER_SECONDS));
+  }
+}
@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include "cached_response.h"
 #include "did/document.h"
+#include "http_error.h"
 #include "visit_each_entry_in_value.h"
 
+#include <atomic>
 #include <ccf/base_endpoint_registry.h>
 #include <ccf/cose_signatures_config_interface.h>
 #include <ccf/crypto/verifier.h>
@@ -32,6 +35,21 @@ namespace scitt
     return out;
   }
 
+  static CachedResponsePtr make_json_response(const nlohmann::json& value)
+  {
+    auto body = value.dump();
+    return std::make_shared<const CachedResponse>(
+      std::vector<uint8_t>(body.begin(), body.end()),
+      ccf::http::headervalues::contenttype::JSON);
+  }
+
+  static CachedResponsePtr make_cbor_response(const nlohmann::json& value)
+  {
+    return std::make_shared<const CachedResponse>(
+      nlohmann::json::to_cbor(value),
+      ccf::http::headervalues::contenttype::CBOR);
+  }
+
   /**
    * An indexing strategy collecting service keys used to sign receipts.
    */
@@ -40,15 +58,46 @@ namespace scitt
   {
   public:
     ServiceKeyIndexingStrategy() :
-      VisitEachEntryInValueTyped(ccf::Tables::SERVICE)
+      VisitEachEntryInValueTyped(ccf::Tables::SERVICE),
+      jwks(build_jwks({}))
     {}
 
-    nlohmann::json get_jwks() const
+    /**
+     * Get the JWKS document listing every service key seen so far.
+     *
+     * The document is only rebuilt when a new service certificate is indexed,
+     * so requests share the same serialized response and don't need to
+     * construct verifiers or JSON. It is published atomically, so requests
+     * never wait for the indexer.
+     */
+    CachedResponsePtr get_jwks() const
     {
-      std::lock_guard guard(lock);
+      return jwks.load();
+    }
+
+  protected:
+    void visit_entry(
+      const ccf::TxID& tx_id, const ccf::ServiceInfo& service_info) override
+    {
+      // It is possible for multiple entries in the ServiceInfo table to contain
+      // the same certificate, eg. if the service status changes. Using an
+      // std::set removes duplicates.
+      if (service_certificates.insert(service_info.cert).second)
+      {
+        jwks.store(build_jwks(service_certificates));
+      }
+    }
+
+  private:
+    // Only accessed by the indexer.
+    std::set<ccf::crypto::Pem> service_certificates;
+    std::atomic<CachedResponsePtr> jwks;
 
+    static CachedResponsePtr build_jwks(
+      const std::set<ccf::crypto::Pem>& certificates)
+    {
       std::vector<nlohmann::json> jwks;
-      for (const auto& service_certificate : service_certificates)
+      for (const auto& service_certificate : certificates)
       {
         auto verifier = ccf::crypto::make_unique_verifier(service_certificate);
         auto kid =
@@ -59,47 +108,31 @@ namespace scitt
       }
       nlohmann::json jwks_json;
       jwks_json["keys"] = jwks;
-      return jwks_json;
-    }
-
-  protected:
-    void visit_entry(
-      const ccf::TxID& tx_id, const ccf::ServiceInfo& service_info) override
-    {
-      std::lock_guard guard(lock);
-
-      // It is possible for multiple entries in the ServiceInfo table to contain
-      // the same certificate, eg. if the service status changes. Using an
-      // std::set removes duplicates.
-      service_certificates.insert(service_info.cert);
+      return make_json_response(jwks_json);
     }
+  };
 
-  private:
-    mutable std::mutex lock;
-
-    std::set<ccf::crypto::Pem> service_certificates;
-  }; /**
-      * An indexing strategy collecting all past and present service
-      * certificates and makes them immediately available.
-      */
+  /**
+   * An indexing strategy collecting all past and present service
+   * certificates and makes them immediately available.
+   */
   class ServiceCertificateIndexingStrategy
     : public VisitEachEntryInValueTyped<ccf::Service>
   {
   public:
     ServiceCertificateIndexingStrategy() :
-      VisitEachEntryInValueTyped(ccf::Tables::SERVICE)
+      VisitEachEntryInValueTyped(ccf::Tables::SERVICE),
+      historic_parameters(build_historic_parameters())
     {}
 
-    std::vector<GetServiceParameters::Out> get_service_parameters() const
+    /**
+     * Get the serialized parameters of every service seen so far, which are
+     * rebuilt whenever a new service certificate is indexed.
+     */
+    CachedResponsePtr get_historic_service_parameters() const
     {
       std::lock_guard guard(lock);
-
-      std::vector<GetServiceParameters::Out> out;
-      for (const auto& certificate : service_certificates)
-      {
-        out.push_back(certificate_to_service_parameters(certificate));
-      }
-      return out;
+      return historic_parameters;
     }
 
   protected:
@@ -111,37 +144,98 @@ namespace scitt
       auto service_cert_der = ccf::crypto::cert_pem_to_der(service_info.cert);
 
       // It is possible for multiple entries in the ServiceInfo table to contain
-      // the same certificate, eg. if the service status changes. Using an
-      // std::set removes duplicates.
-      service_certificates.insert(service_cert_der);
+      // the same certificate, eg. if the service status changes. Keying the
+      // map by certificate removes duplicates.
+      if (service_certificates.contains(service_cert_der))
+      {
+        return;
+      }
+
+      auto service_parameters =
+        certificate_to_service_parameters(service_cert_der);
+      service_certificates.emplace(
+        std::move(service_cert_der), std::move(service_parameters));
+      historic_parameters = build_historic_parameters();
     }
 
   private:
     mutable std::mutex lock;
 
-    // Set of DER-encoded certificates
-    std::set<std::vector<uint8_t>> service_certificates;
+    // DER-encoded certificates, and the service parameters derived from them
+    std::map<std::vector<uint8_t>, GetServiceParameters::Out>
+      service_certificates;
+    CachedResponsePtr historic_parameters;
+
+    CachedResponsePtr build_historic_parameters() const
+    {
+      GetHistoricServiceParameters::Out out;
+      for (const auto& [certificate, parameters] : service_certificates)
+      {
+        out.parameters.push_back(parameters);
+      }
+      return make_json_response(out);
+    }
   };
 
   namespace endpoints
   {
-    static GetServiceParameters::Out get_service_parameters(
-      ccf::endpoints::EndpointContext& ctx, nlohmann::json&& params)
+    /**
+     * Reject requests whose Accept header doesn't allow a JSON response, as
+     * ccf::json_adapter would, since cached responses are served as is.
+     */
+    static void check_accepts_json(ccf::RpcContext& rpc_ctx)
     {
+      const auto accept =
+        rpc_ctx.get_request_header(ccf::http::headers::ACCEPT);
+      if (!accept.has_value())
+      {
+        return;
+      }
+
+      const auto fields = ccf::http::parse_accept_header(accept.value());
+      for (const auto& field : fields)
+      {
+        if (field.matches(ccf::http::headervalues::contenttype::JSON))
+        {
+          return;
+        }
+      }
+      throw NotAcceptableJsonError(
+        ccf::errors::UnsupportedContentType,
+        fmt::format(
+          "No supported content type in accept header: {}\nOnly {} is "
+          "currently supported",
+          accept.value(),
+          ccf::http::headervalues::contenttype::JSON));
+    }
+
+    /**
+     * The service certificate only changes on disaster recovery, so the
+     * response is cached and only rebuilt when the certificate differs from
+     * the one it was built from.
+     */
+    static void get_service_parameters(
+      const std::shared_ptr<ResponseCache<ccf::crypto::Pem>>& cache,
+      ccf::endpoints::ReadOnlyEndpointContext& ctx)
+    {
+      check_accepts_json(*ctx.rpc_ctx);
+
       auto service = ctx.tx.template ro<ccf::Service>(ccf::Tables::SERVICE);
       auto service_info = service->get().value();
-      auto service_cert_der = ccf::crypto::cert_pem_to_der(service_info.cert);
-      return certificate_to_service_parameters(service_cert_der);
+      auto response = cache->get(service_info.cert, [&] {
+        auto service_cert_der = ccf::crypto::cert_pem_to_der(service_info.cert);
+        return make_json_response(
+          certificate_to_service_parameters(service_cert_der));
+      });
+      response->respond(*ctx.rpc_ctx);
     }
 
-    static GetHistoricServiceParameters::Out get_historic_service_parameters(
+    static void get_historic_service_parameters(
       const std::shared_ptr<ServiceCertificateIndexingStrategy>& index,
-      ccf::endpoints::EndpointContext& ctx,
-      nlohmann::json&& params)
+      ccf::endpoints::EndpointContext& ctx)
     {
-      GetHistoricServiceParameters::Out out;
-      out.parameters = index->get_service_parameters();
-      return out;
+      check_accepts_json(*ctx.rpc_ctx);
+      index->get_historic_service_parameters()->respond(*ctx.rpc_ctx);
     }
 
     static Configuration get_configuration(
@@ -160,13 +254,12 @@ namespace scitt
       return out;
     };
 
-    static nlohmann::json get_jwks(
+    static void get_jwks(
       const std::shared_ptr<ServiceKeyIndexingStrategy>& index,
-      ccf::endpoints::EndpointContext& ctx,
-      nlohmann::json&& params)
+      ccf::endpoints::EndpointContext& ctx)
     {
       // TODO: this is not right when the indexer is not up to date
-      return index->get_jwks();
+      index->get_jwks()->respond(*ctx.rpc_ctx);
     }
   }
 
@@ -187,8 +280,17 @@ namespace scitt
 
     context.get_indexing_strategies().install_strategy(service_key_index);
 
+    auto service_parameters_cache =
+      std::make_shared<ResponseCache<ccf::crypto::Pem>>();
+
+    // The transparency configuration only depends on the issuer, which is
+    // part of the node's startup configuration.
+    auto transparency_config_cache =
+      std::make_shared<ResponseCache<std::string>>();
+
     auto get_transparency_config =
-      [&](ccf::endpoints::ReadOnlyEndpointContext& ctx) {
+      [&context, transparency_config_cache](
+        ccf::endpoints::ReadOnlyEndpointContext& ctx) {
         auto subsystem =
           context.get_subsystem<ccf::cose::AbstractCOSESignaturesConfig>();
         if (!subsystem)
@@ -197,25 +299,24 @@ namespace scitt
         }
         auto cfg = subsystem->get_cose_signatures_config();
 
-        nlohmann::json config;
-        config["issuer"] = cfg.issuer;
-        config["jwks_uri"] = fmt::format("https://{}/jwks", cfg.issuer);
-        ctx.rpc_ctx->set_response_status(HTTP_STATUS_OK);
-        ctx.rpc_ctx->set_response_header(
-          ccf::http::headers::CONTENT_TYPE,
-          ccf::http::headervalues::contenttype::CBOR);
-        ctx.rpc_ctx->set_response_body(nlohmann::json::to_cbor(config));
-        return;
+        auto response = transparency_config_cache->get(cfg.issuer, [&] {
+          nlohmann::json config;
+          config["issuer"] = cfg.issuer;
+          config["jwks_uri"] = fmt::format("https://{}/jwks", cfg.issuer);
+          return make_cbor_response(config);
+        });
+        response->respond(*ctx.rpc_ctx);
       };
 
     /**
      * The endpoint exposes the current service parameters.
      */
     registry
-      .make_endpoint(
+      .make_read_only_endpoint(
         "/parameters",
         HTTP_GET,
-        ccf::json_adapter(endpoints::get_service_parameters),
+        std::bind(
+          endpoints::get_service_parameters, service_parameters_cache, _1),
         no_authn_policy)
       .set_auto_schema<void, GetServiceParameters::Out>()
       .install();
@@ -229,11 +330,10 @@ namespace scitt
       .make_endpoint(
         "/parameters/historic",
         HTTP_GET,
-        ccf::json_adapter(std::bind(
+        std::bind(
           endpoints::get_historic_service_parameters,
           service_certificate_index,
-          _1,
-          _2)),
+          _1),
         no_authn_policy)
       .set_auto_schema<void, GetHistoricServiceParameters::Out>()
       .set_forwarding_required(ccf::endpoints::ForwardingRequired::Never)
@@ -278,9 +378,9 @@ namespace scitt
       .make_endpoint(
         "/jwks",
         HTTP_GET,
-        ccf::json_adapter(
-          std::bind(endpoints::get_jwks, service_key_index, _1, _2)),
+        std::bind(endpoints::get_jwks, service_key_index, _1),
         no_authn_policy)
+      .set_forwarding_required(ccf::endpoints::ForwardingRequired::Never)
       .install();
 
     /**
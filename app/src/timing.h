@@ -0,0 +1,158 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "metrics.h"
+
+#include <array>
+#include <chrono>
+#include <fmt/format.h>
+#include <string>
+#include <string_view>
+
+namespace scitt::timing
+{
+  /**
+   * Phases of statement registration which are timed individually.
+   */
+  enum class Stage : size_t
+  {
+    Decode,
+    Signature,
+    DidX509,
+    Snp,
+    Policy,
+    Kv,
+  };
+
+  static constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Kv) + 1;
+
+  static constexpr std::array<std::string_view, STAGE_COUNT> STAGE_NAMES = {
+    "Decode",
+    "Signature",
+    "DidX509",
+    "Snp",
+    "Policy",
+    "Kv",
+  };
+
+  constexpr std::string_view stage_name(Stage stage)
+  {
+    return STAGE_NAMES[static_cast<size_t>(stage)];
+  }
+
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Time spent in each stage by the request currently being processed on this
+   * thread. A stage may be entered more than once, in which case its
+   * durations are added up.
+   */
+  struct StageTimings
+  {
+    std::array<Clock::duration, STAGE_COUNT> durations = {};
+    std::array<bool, STAGE_COUNT> recorded = {};
+
+    void add(Stage stage, Clock::duration duration)
+    {
+      auto i = static_cast<size_t>(stage);
+      durations[i] += duration;
+      recorded[i] = true;
+    }
+
+    bool empty() const
+    {
+      for (bool r : recorded)
+      {
+        if (r)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Format the recorded stages as space-separated key-value pairs, with
+     * durations in microseconds, eg. "DecodeUs=12 SignatureUs=340".
+     */
+    std::string to_string() const
+    {
+      fmt::memory_buffer out;
+      for (size_t i = 0; i < STAGE_COUNT; i++)
+      {
+        if (!recorded[i])
+        {
+          continue;
+        }
+        fmt::format_to(
+          std::back_inserter(out),
+          "{}{}Us={}",
+          out.size() > 0 ? " " : "",
+          STAGE_NAMES[i],
+          std::chrono::duration_cast<std::chrono::microseconds>(durations[i])
+            .count());
+      }
+      return fmt::to_string(out);
+    }
+  };
+
+  inline thread_local StageTimings stage_timings;
+
+  /**
+   * Adds the time spent in a scope to the current request's timings.
+   */
+  class ScopedStageTimer
+  {
+  public:
+    ScopedStageTimer(Stage stage) : stage(stage), start(Clock::now()) {}
+
+    ~ScopedStageTimer()
+    {
+      stage_timings.add(stage, Clock::now() - start);
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+  private:
+    Stage stage;
+    Clock::time_point start;
+  };
+
+  /**
+   * Histograms of the time spent in each stage, aggregated over all requests
+   * handled by this node.
+   */
+  static metrics::Histogram& stage_histogram(Stage stage)
+  {
+    static const auto histograms = [] {
+      std::array<metrics::Histogram*, STAGE_COUNT> histograms;
+      for (size_t i = 0; i < STAGE_COUNT; i++)
+      {
+        histograms[i] = &metrics::registry().histogram(
+          "scitt_registration_stage_duration_seconds",
+          "Time spent in each stage of signed statement registration",
+          {{"stage", std::string(STAGE_NAMES[i])}},
+          metrics::MICROSECONDS);
+      }
+      return histograms;
+    }();
+    return *histograms[static_cast<size_t>(stage)];
+  }
+
+  /**
+   * Add the stages recorded by the current request to the histograms.
+   */
+  static void record_stage_timings(const StageTimings& timings)
+  {
+    for (size_t i = 0; i < STAGE_COUNT; i++)
+    {
+      if (timings.recorded[i])
+      {
+        stage_histogram(static_cast<Stage>(i)).record(timings.durations[i]);
+      }
+    }
+  }
+}
@@ -6,13 +6,19 @@
 #include "app_data.h"
 #include "cbor.h"
 #include "constants.h"
+#include "flight_recorder.h"
+#include "metrics.h"
+#include "timing.h"
 #include "util.h"
 
 #include <ccf/base_endpoint_registry.h>
 #include <ccf/ds/logger.h>
 #include <ccf/endpoint_context.h>
+#include <ccf/kv/read_only_store.h>
+#include <charconv>
 #include <ctime>
 #include <functional>
+#include <map>
 #include <regex>
 
 namespace scitt
@@ -33,6 +39,7 @@ namespace scitt
   {
     request_id = std::nullopt;
     client_request_id = std::nullopt;
+    timing::stage_timings = {};
   }
 
   static long diff_timespec_ms(
@@ -42,28 +49,107 @@ namespace scitt
       (time1.tv_nsec - time0.tv_nsec) / 1000000;
   }
 
+  /**
+   * Fast per-thread pseudo-random numbers, for request IDs and log sampling.
+   * These only need to be unique and evenly distributed, not unpredictable,
+   * so the entropy source is only used once per thread, as a seed.
+   */
+  static uint64_t next_random()
+  {
+    // SplitMix64
+    thread_local uint64_t state = ENTROPY->random64();
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+
   static std::string create_request_id()
   {
-    return fmt::format("{:x}", ENTROPY->random64());
+    std::array<char, 16> buffer;
+    auto [end, ec] = std::to_chars(
+      buffer.data(), buffer.data() + buffer.size(), next_random(), 16);
+    return std::string(buffer.data(), end);
   }
 
-  static std::string tracing_context()
+  /**
+   * Logging settings, from the service configuration.
+   */
+  struct LogSettings
   {
-    fmt::memory_buffer out;
-    if (client_request_id.has_value())
+    /**
+     * Fraction of requests to each endpoint, keyed by path, whose start and
+     * end are logged. Endpoints which are not listed are always logged, as
+     * are requests which fail.
+     */
+    std::map<std::string, double> sampling;
+
+    /**
+     * Log a single line per request stage, when it ends, instead of one when
+     * it starts and one when it ends. Fields which are redundant with the URL
+     * are omitted.
+     */
+    bool compact = false;
+
+    /**
+     * Requests whose main handler takes at least this long are recorded by
+     * the flight recorder, along with their stage timings. Nothing is
+     * recorded if unset.
+     */
+    std::optional<uint64_t> slow_request_threshold_ms;
+
+    bool is_sampled(const std::string& path) const
     {
-      fmt::format_to(
-        std::back_inserter(out),
-        "ClientRequestId={} ",
-        client_request_id.value());
+      auto it = sampling.find(path);
+      if (it == sampling.end() || it->second >= 1)
+      {
+        return true;
+      }
+      // Compare the top 53 bits, which a double represents exactly.
+      return static_cast<double>(next_random() >> 11) * 0x1.0p-53 < it->second;
     }
-    if (request_id.has_value())
+
+    bool operator==(const LogSettings& other) const = default;
+  };
+
+  using GetLogSettings =
+    std::function<std::shared_ptr<const LogSettings>(ccf::kv::ReadOnlyTx& tx)>;
+
+  /**
+   * Placeholder for the request IDs of the current thread, which are only
+   * formatted if and when a log line is emitted.
+   */
+  struct TracingContext
+  {};
+}
+
+template <>
+struct fmt::formatter<scitt::TracingContext>
+{
+  constexpr auto parse(format_parse_context& ctx)
+  {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const scitt::TracingContext&, FormatContext& ctx) const
+  {
+    auto out = ctx.out();
+    if (scitt::client_request_id.has_value())
+    {
+      out = fmt::format_to(
+        out, "ClientRequestId={} ", scitt::client_request_id.value());
+    }
+    if (scitt::request_id.has_value())
     {
-      fmt::format_to(
-        std::back_inserter(out), "RequestId={} ", request_id.value());
+      out = fmt::format_to(out, "RequestId={} ", scitt::request_id.value());
     }
-    return fmt::to_string(out);
+    return out;
   }
+};
+
+namespace scitt
+{
 
 // The ## syntax is GCC extension, for which we need to disable warnings.
 // C++20 has a standard alternative, __VA_OPT__, we could use, but clang has a
@@ -80,7 +166,7 @@ namespace scitt
 // /tmp/app/src/tracing.h:181      | ::START:: Stage=MAIN Verb=POST
 // Path=/entries Query= URL=/entries RequestId=c90fff41f2f59642
 #define SCITT_LOG(f, s, ...) \
-  f(s " {}", ##__VA_ARGS__, ::scitt::tracing_context())
+  f(s " {}", ##__VA_ARGS__, ::scitt::TracingContext{})
 
 #define SCITT_TRACE(s, ...) SCITT_LOG(CCF_APP_TRACE, s, ##__VA_ARGS__)
 #define SCITT_DEBUG(s, ...) SCITT_LOG(CCF_APP_DEBUG, s, ##__VA_ARGS__)
@@ -98,6 +184,17 @@ namespace scitt
   {
     AppData& app_data = get_app_data(rpc_ctx);
 
+    // Stage timings are only collected by the main handler.
+    if (!timing::stage_timings.empty())
+    {
+      timing::record_stage_timings(timing::stage_timings);
+    }
+
+    if (!app_data.log_sampled && rpc_ctx->get_response_status() < 400)
+    {
+      return;
+    }
+
     ::timespec end;
     ccf::ApiResult result = get_time(end);
     if (result != ccf::ApiResult::OK)
@@ -120,11 +217,30 @@ namespace scitt
         "Computed request duration is negative: {} ms. Ignoring.", duration_ms);
     }
 
-    if (txid.has_value())
+    std::string stages;
+    if (!timing::stage_timings.empty())
+    {
+      stages = " " + timing::stage_timings.to_string();
+    }
+
+    if (app_data.log_compact)
+    {
+      SCITT_INFO(
+        "::END:: Stage={} Verb={} URL={} Status={}{}{} TimeMs={}{}",
+        fn_stage_name,
+        rpc_ctx->get_request_verb().c_str(),
+        rpc_ctx->get_request_url(),
+        rpc_ctx->get_response_status(),
+        txid.has_value() ? " TxId=" : "",
+        txid.has_value() ? txid->to_str() : "",
+        duration_ms,
+        stages);
+    }
+    else if (txid.has_value())
     {
       SCITT_INFO(
         "::END:: Stage={} Verb={} Path={} Query={} URL={} Status={} TxId={} "
-        "TimeMs={}",
+        "TimeMs={}{}",
         fn_stage_name,
         rpc_ctx->get_request_verb().c_str(),
         path,
@@ -132,22 +248,47 @@ namespace scitt
         rpc_ctx->get_request_url(),
         rpc_ctx->get_response_status(),
         txid->to_str(),
-        std::to_string(duration_ms));
+        std::to_string(duration_ms),
+        stages);
     }
     else
     {
       SCITT_INFO(
-        "::END:: Stage={} Verb={} Path={} Query={} URL={} Status={} TimeMs={}",
+        "::END:: Stage={} Verb={} Path={} Query={} URL={} Status={} "
+        "TimeMs={}{}",
         fn_stage_name,
         rpc_ctx->get_request_verb().c_str(),
         path,
         rpc_ctx->get_request_query().c_str(),
         rpc_ctx->get_request_url(),
         rpc_ctx->get_response_status(),
-        std::to_string(duration_ms));
+        std::to_string(duration_ms),
+        stages);
     }
   }
 
+  static void record_slow_request(
+    ccf::endpoints::EndpointContext& ctx,
+    const std::string& path,
+    timing::Clock::duration elapsed)
+  {
+    const AppData& app_data = get_app_data(ctx.rpc_ctx);
+
+    SlowRequest request;
+    request.request_id = app_data.request_id.value_or("");
+    request.client_request_id = app_data.client_request_id;
+    request.verb = ctx.rpc_ctx->get_request_verb().c_str();
+    request.path = path;
+    request.status = ctx.rpc_ctx->get_response_status();
+    request.body_size = ctx.rpc_ctx->get_request_body().size();
+    request.issuer_type = app_data.issuer_type;
+    request.duration_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    request.set_stages(timing::stage_timings);
+
+    flight_recorder().record(std::move(request));
+  }
+
   /**
    * This tracing adapter is wrapping the main endpoint logic that can fail.
    * In a case of success it will continue executing a local commit handler.
@@ -155,10 +296,27 @@ namespace scitt
   static ccf::endpoints::EndpointFunction tracing_adapter_first(
     ccf::endpoints::EndpointFunction fn,
     const std::string& path,
-    const std::function<ccf::ApiResult(::timespec& time)>& get_time)
+    const std::function<ccf::ApiResult(::timespec& time)>& get_time,
+    const GetLogSettings& get_log_settings)
   {
-    return [fn, path, get_time](ccf::endpoints::EndpointContext& ctx) {
+    auto* requests = &metrics::registry().counter(
+      "scitt_requests_total",
+      "Number of requests handled, by endpoint",
+      {{"endpoint", path}});
+    auto* errors = &metrics::registry().counter(
+      "scitt_request_errors_total",
+      "Number of requests which returned an error status, by endpoint",
+      {{"endpoint", path}});
+    auto* latency = &metrics::registry().histogram(
+      "scitt_request_duration_seconds",
+      "Time spent in the main handler of each endpoint",
+      {{"endpoint", path}},
+      metrics::MICROSECONDS);
+
+    return [fn, path, get_time, get_log_settings, requests, errors, latency](
+             ccf::endpoints::EndpointContext& ctx) {
       auto cleanup = finally(clear_trace_state);
+      const auto started = timing::Clock::now();
 
       request_id = create_request_id();
       ctx.rpc_ctx->set_response_header(REQUEST_ID_HEADER, request_id.value());
@@ -179,13 +337,20 @@ namespace scitt
       app_data.request_id = request_id;
       app_data.client_request_id = client_request_id;
 
-      SCITT_INFO(
-        "::START:: Stage={} Verb={} Path={} Query={} URL={}",
-        FN_STAGE_MAIN,
-        ctx.rpc_ctx->get_request_verb().c_str(),
-        path,
-        ctx.rpc_ctx->get_request_query().c_str(),
-        ctx.rpc_ctx->get_request_url());
+      const auto log_settings = get_log_settings(ctx.tx);
+      app_data.log_sampled = log_settings->is_sampled(path);
+      app_data.log_compact = log_settings->compact;
+
+      if (app_data.log_sampled && !app_data.log_compact)
+      {
+        SCITT_INFO(
+          "::START:: Stage={} Verb={} Path={} Query={} URL={}",
+          FN_STAGE_MAIN,
+          ctx.rpc_ctx->get_request_verb().c_str(),
+          path,
+          ctx.rpc_ctx->get_request_query().c_str(),
+          ctx.rpc_ctx->get_request_url());
+      }
 
       ::timespec start;
       ccf::ApiResult result = get_time(app_data.start_time);
@@ -205,6 +370,22 @@ namespace scitt
 
       fn(ctx);
 
+      const auto elapsed = timing::Clock::now() - started;
+      latency->record(elapsed);
+      requests->increment();
+      if (ctx.rpc_ctx->get_response_status() >= 400)
+      {
+        errors->increment();
+      }
+
+      const auto& threshold = log_settings->slow_request_threshold_ms;
+      if (
+        threshold.has_value() &&
+        elapsed >= std::chrono::milliseconds(threshold.value()))
+      {
+        record_slow_request(ctx, path, elapsed);
+      }
+
       log_request_end(ctx.rpc_ctx, FN_STAGE_MAIN, path, get_time);
     };
   }
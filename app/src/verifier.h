@@ -5,9 +5,11 @@
 
 #include "cose.h"
 #include "didx509cpp/didx509cpp.h"
+#include "issuer_costs.h"
 #include "kv_types.h"
 #include "public_key.h"
 #include "signature_algorithms.h"
+#include "timing.h"
 #include "tracing.h"
 #include "verified_details.h"
 
@@ -146,6 +148,57 @@ namespace scitt::verifier
       }
     }
 
+    /**
+     * Check the headers of a signed statement against the limits of the
+     * policy which don't require any cryptographic verification.
+     */
+    static void check_header_limits(
+      const cose::ProtectedHeader& phdr,
+      const cose::UnprotectedHeader& uhdr,
+      const Configuration::Policy& policy)
+    {
+      if (
+        policy.max_protected_header_size.has_value() &&
+        phdr.encoded_size > policy.max_protected_header_size.value())
+      {
+        throw VerificationError(fmt::format(
+          "Protected header size {} exceeds maximum allowed size {}",
+          phdr.encoded_size,
+          policy.max_protected_header_size.value()));
+      }
+
+      if (policy.max_x5chain_length.has_value())
+      {
+        for (const auto* x5chain : {&phdr.x5chain, &uhdr.x5chain})
+        {
+          if (
+            x5chain->has_value() &&
+            x5chain->value().size() > policy.max_x5chain_length.value())
+          {
+            throw VerificationError(fmt::format(
+              "x5chain length {} exceeds maximum allowed length {}",
+              x5chain->value().size(),
+              policy.max_x5chain_length.value()));
+          }
+        }
+      }
+
+      if (policy.accepted_issuer_prefixes.has_value())
+      {
+        const auto& iss = phdr.cwt_claims.iss;
+        const auto& prefixes = policy.accepted_issuer_prefixes.value();
+        if (
+          !iss.has_value() ||
+          std::none_of(
+            prefixes.begin(), prefixes.end(), [&](const auto& prefix) {
+              return iss->starts_with(prefix);
+            }))
+        {
+          throw VerificationError("Unsupported issuer in protected header");
+        }
+      }
+    }
+
     std::span<uint8_t> process_signed_statement_with_didx509_issuer(
       const cose::ProtectedHeader& phdr,
       const Configuration& configuration,
@@ -160,6 +213,7 @@ namespace scitt::verifier
       std::span<uint8_t> payload;
       try
       {
+        timing::ScopedStageTimer timer(timing::Stage::Signature);
         payload = cose::verify(data, key);
       }
       catch (const cose::COSESignatureValidationError& e)
@@ -168,6 +222,7 @@ namespace scitt::verifier
       }
 
       // Then authenticate the did:x509 claim against the x5chain
+      timing::ScopedStageTimer timer(timing::Stage::DidX509);
       std::string pem_chain;
       for (auto const& c : phdr.x5chain.value())
       {
@@ -292,6 +347,7 @@ namespace scitt::verifier
         // Instruct t_cose to ignore critical header params it does not
         // understand as the attestedsvc header param is custom and not part of
         // the COSE standard. Crit checking is done per issuer-type later on.
+        timing::ScopedStageTimer timer(timing::Stage::Signature);
         payload = cose::verify(data, public_key, true);
       }
       catch (const cose::COSESignatureValidationError& e)
@@ -314,29 +370,32 @@ namespace scitt::verifier
       ccf::pal::PlatformAttestationReportData report_data = {};
       std::optional<ccf::pal::UVMEndorsements> parsed_uvm_endorsements;
 
-      try
-      {
-        ccf::pal::verify_snp_attestation_report(
-          quote_info, measurement, report_data);
-      }
-      catch (const std::exception& e)
-      {
-        throw VerificationError(fmt::format(
-          "Failed to validate SNP attestation report: {}", e.what()));
-      }
-
-      if (phdr.tss_map.uvm_endorsements.has_value())
       {
+        timing::ScopedStageTimer timer(timing::Stage::Snp);
         try
         {
-          parsed_uvm_endorsements =
-            ccf::pal::verify_uvm_endorsements_descriptor(
-              phdr.tss_map.uvm_endorsements.value(), measurement);
+          ccf::pal::verify_snp_attestation_report(
+            quote_info, measurement, report_data);
         }
         catch (const std::exception& e)
         {
-          throw VerificationError(
-            fmt::format("Failed to validate UVM endorsements: {}", e.what()));
+          throw VerificationError(fmt::format(
+            "Failed to validate SNP attestation report: {}", e.what()));
+        }
+
+        if (phdr.tss_map.uvm_endorsements.has_value())
+        {
+          try
+          {
+            parsed_uvm_endorsements =
+              ccf::pal::verify_uvm_endorsements_descriptor(
+                phdr.tss_map.uvm_endorsements.value(), measurement);
+          }
+          catch (const std::exception& e)
+          {
+            throw VerificationError(
+              fmt::format("Failed to validate UVM endorsements: {}", e.what()));
+          }
         }
       }
 
@@ -407,6 +466,45 @@ namespace scitt::verifier
       return {payload, details};
     }
 
+    /**
+     * Decode the headers of a signed statement, without verifying anything.
+     * This is cheap, and lets callers reject a signed statement based on its
+     * headers before any cryptographic verification takes place.
+     */
+    static std::tuple<cose::ProtectedHeader, cose::UnprotectedHeader>
+    decode_signed_statement(const std::vector<uint8_t>& signed_statement)
+    {
+      timing::ScopedStageTimer timer(timing::Stage::Decode);
+      try
+      {
+        return cose::decode_headers(signed_statement);
+      }
+      catch (const cose::COSEDecodeError& e)
+      {
+        throw VerificationError(e.what());
+      }
+    }
+
+    std::tuple<
+      cose::ProtectedHeader,
+      cose::UnprotectedHeader,
+      std::span<uint8_t>,
+      std::optional<VerifiedSevSnpAttestationDetails>>
+    verify_signed_statement(
+      const std::vector<uint8_t>& signed_statement,
+      ccf::kv::ReadOnlyTx& tx,
+      ::timespec current_time,
+      const Configuration& configuration)
+    {
+      auto [phdr, uhdr] = decode_signed_statement(signed_statement);
+      return verify_signed_statement(
+        signed_statement, phdr, uhdr, tx, current_time, configuration);
+    }
+
+    /**
+     * Verify a signed statement whose headers were already decoded by
+     * decode_signed_statement().
+     */
     std::tuple<
       cose::ProtectedHeader,
       cose::UnprotectedHeader,
@@ -414,17 +512,31 @@ namespace scitt::verifier
       std::optional<VerifiedSevSnpAttestationDetails>>
     verify_signed_statement(
       const std::vector<uint8_t>& signed_statement,
+      const cose::ProtectedHeader& phdr,
+      const cose::UnprotectedHeader& uhdr,
       ccf::kv::ReadOnlyTx& tx,
       ::timespec current_time,
       const Configuration& configuration)
     {
-      cose::ProtectedHeader phdr;
-      cose::UnprotectedHeader uhdr;
       std::span<uint8_t> payload;
       std::optional<VerifiedSevSnpAttestationDetails> details;
+
+      // Attribute the cost of verification to the issuer, whether or not it
+      // succeeds.
+      const auto started = timing::Clock::now();
+      auto record_cost = finally([&]() {
+        if (phdr.cwt_claims.iss.has_value())
+        {
+          issuer_costs().record(
+            phdr.cwt_claims.iss.value(),
+            timing::Clock::now() - started,
+            signed_statement.size());
+        }
+      });
+
       try
       {
-        std::tie(phdr, uhdr) = cose::decode_headers(signed_statement);
+        check_header_limits(phdr, uhdr, configuration.policy);
 
         if (contains_cwt_issuer(phdr))
         {
@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "cached_response.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt;
+
+namespace
+{
+  TEST(CachedResponseTest, EtagIsQuotedBodyDigest)
+  {
+    CachedResponse a({'{', '}'}, "application/json");
+    CachedResponse b({'{', '}'}, "application/json");
+    CachedResponse c({'[', ']'}, "application/json");
+
+    EXPECT_EQ(a.get_etag(), b.get_etag());
+    EXPECT_NE(a.get_etag(), c.get_etag());
+    EXPECT_EQ(a.get_etag().size(), 66);
+    EXPECT_EQ(a.get_etag().front(), '"');
+    EXPECT_EQ(a.get_etag().back(), '"');
+  }
+
+  TEST(CachedResponseTest, MatchesIfNoneMatch)
+  {
+    const std::string etag = "\"abc\"";
+
+    EXPECT_TRUE(CachedResponse::matches("\"abc\"", etag));
+    EXPECT_TRUE(CachedResponse::matches("W/\"abc\"", etag));
+    EXPECT_TRUE(CachedResponse::matches("*", etag));
+    EXPECT_TRUE(CachedResponse::matches("\"xyz\", \"abc\"", etag));
+    EXPECT_TRUE(CachedResponse::matches(" \"abc\" ,\"xyz\"", etag));
+
+    EXPECT_FALSE(CachedResponse::matches("", etag));
+    EXPECT_FALSE(CachedResponse::matches(" , ", etag));
+    EXPECT_FALSE(CachedResponse::matches("abc", etag));
+    EXPECT_FALSE(CachedResponse::matches("\"abcd\"", etag));
+    EXPECT_FALSE(CachedResponse::matches("\"xyz\", W/\"ab\"", etag));
+  }
+}
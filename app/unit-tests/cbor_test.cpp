@@ -83,4 +83,56 @@ namespace
       to_hex_string(thumbprint),
       "f6ac24a26f78f324d165e6cd637b8fd0aba2e42bf10c331fddc046c13d0b6e77");
   }
+
+  TEST(CborTest, EncodedItemsToCborArray)
+  {
+    EXPECT_EQ(
+      to_hex_string(scitt::cbor::encoded_items_to_cbor_array({})), "80");
+
+    // [1, "a"]
+    auto array = scitt::cbor::encoded_items_to_cbor_array(
+      {from_hex_string("01"), from_hex_string("6161")});
+    EXPECT_EQ(to_hex_string(array), "82016161");
+  }
+
+  TEST(CborTest, OperationLookupError)
+  {
+    // {"OperationId": "2.5", "LookupError": {-1: "NotFound", -2: "x"}}
+    EXPECT_EQ(
+      to_hex_string(
+        scitt::cbor::operation_lookup_error_to_cbor("2.5", "NotFound", "x")),
+      "a26b4f7065726174696f6e496463322e356b4c6f6f6b75704572726f72a220684e6f7446"
+      "6f756e64216178");
+  }
+
+  TEST(CborTest, DecodeTextArray)
+  {
+    // ["2.10", "2.11"]
+    auto items = scitt::cbor::decode_text_array(
+      from_hex_string("8264322e313064322e3131"), 10);
+    EXPECT_THAT(items, ElementsAre("2.10", "2.11"));
+
+    EXPECT_THAT(
+      scitt::cbor::decode_text_array(from_hex_string("80"), 10), IsEmpty());
+  }
+
+  TEST(CborTest, DecodeTextArrayInvalid)
+  {
+    // Not an array
+    EXPECT_THROW(
+      scitt::cbor::decode_text_array(from_hex_string("6161"), 10),
+      std::invalid_argument);
+    // Array of integers
+    EXPECT_THROW(
+      scitt::cbor::decode_text_array(from_hex_string("820102"), 10),
+      std::invalid_argument);
+    // Too many items
+    EXPECT_THROW(
+      scitt::cbor::decode_text_array(from_hex_string("83616161616161"), 2),
+      std::invalid_argument);
+    // Trailing data
+    EXPECT_THROW(
+      scitt::cbor::decode_text_array(from_hex_string("8001"), 10),
+      std::invalid_argument);
+  }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "configurable_auth.h"
 
 #include <gtest/gtest.h>
+#include <map>
 #include <nlohmann/json.hpp>
 
 using namespace scitt;
@@ -103,4 +104,137 @@ namespace
       R"({ "data": [ "foo", "bar" ] })",
       R"({ "data": [ "foo" ] })"));
   }
+
+  class VerifiedJwtCacheTest : public ::testing::Test
+  {
+  protected:
+    static constexpr time_t EXPIRY = 1000;
+    static constexpr ccf::kv::Version CONFIG_VERSION = 5;
+
+    ccf::JwtAuthnIdentity make_identity(
+      const std::string& subject, const std::string& key_id = "key")
+    {
+      ccf::JwtAuthnIdentity identity;
+      identity.header = {{"kid", key_id}};
+      identity.payload = {{"sub", subject}, {"exp", EXPIRY}};
+      return identity;
+    }
+
+    VerifiedJwtCache::TokenDigest store(
+      const std::string& subject, const std::string& key_id = "key")
+    {
+      const auto digest = VerifiedJwtCache::get_digest("Bearer " + subject);
+      cache.store(
+        digest,
+        CONFIG_VERSION,
+        make_identity(subject, key_id),
+        std::nullopt,
+        get_key_version);
+      return digest;
+    }
+
+    std::shared_ptr<const VerifiedJwtCache::Entry> lookup(
+      const VerifiedJwtCache::TokenDigest& digest,
+      time_t now = EXPIRY - 1,
+      ccf::kv::Version config_version = CONFIG_VERSION)
+    {
+      return cache.lookup(digest, now, config_version, get_key_version);
+    }
+
+    VerifiedJwtCache cache{10};
+    std::map<std::string, ccf::kv::Version> key_versions = {{"key", 3}};
+    VerifiedJwtCache::GetKeyVersion get_key_version =
+      [this](const std::string& key_id) -> std::optional<ccf::kv::Version> {
+      auto it = key_versions.find(key_id);
+      if (it == key_versions.end())
+      {
+        return std::nullopt;
+      }
+      return it->second;
+    };
+  };
+
+  TEST_F(VerifiedJwtCacheTest, Hit)
+  {
+    const auto digest = store("alice");
+    const auto entry = lookup(digest);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->identity.payload["sub"], "alice");
+    EXPECT_FALSE(entry->claims_error.has_value());
+  }
+
+  TEST_F(VerifiedJwtCacheTest, Expired)
+  {
+    const auto digest = store("alice");
+    EXPECT_EQ(lookup(digest, EXPIRY), nullptr);
+
+    // Stale entries are removed
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(lookup(digest), nullptr);
+  }
+
+  TEST_F(VerifiedJwtCacheTest, ConfigurationChanged)
+  {
+    const auto digest = store("alice");
+    EXPECT_EQ(lookup(digest, EXPIRY - 1, CONFIG_VERSION + 1), nullptr);
+    EXPECT_EQ(lookup(digest), nullptr);
+  }
+
+  TEST_F(VerifiedJwtCacheTest, KeyRotated)
+  {
+    const auto digest = store("alice");
+    key_versions["key"] = 4;
+    EXPECT_EQ(lookup(digest), nullptr);
+  }
+
+  TEST_F(VerifiedJwtCacheTest, KeyRemoved)
+  {
+    const auto digest = store("alice");
+    key_versions.erase("key");
+    EXPECT_EQ(lookup(digest), nullptr);
+  }
+
+  TEST_F(VerifiedJwtCacheTest, OtherKeysUpdated)
+  {
+    const auto digest = store("alice");
+    key_versions["other"] = 7;
+    EXPECT_NE(lookup(digest), nullptr);
+  }
+
+  TEST_F(VerifiedJwtCacheTest, DifferentHeaders)
+  {
+    const auto alice = store("alice");
+    EXPECT_EQ(
+      lookup(VerifiedJwtCache::get_digest("Bearer mallory")), nullptr);
+    EXPECT_EQ(lookup(VerifiedJwtCache::get_digest("Bearer alice ")), nullptr);
+
+    // Each header only ever finds its own token
+    const auto bob = store("bob");
+    EXPECT_EQ(lookup(alice)->identity.payload["sub"], "alice");
+    EXPECT_EQ(lookup(bob)->identity.payload["sub"], "bob");
+  }
+
+  TEST_F(VerifiedJwtCacheTest, NotRemembered)
+  {
+    // Tokens without an expiry time or key ID are verified every time.
+    auto identity = make_identity("alice");
+    identity.payload.erase("exp");
+    cache.store(
+      VerifiedJwtCache::get_digest("Bearer alice"),
+      CONFIG_VERSION,
+      identity,
+      std::nullopt,
+      get_key_version);
+
+    identity = make_identity("bob");
+    identity.header.erase("kid");
+    cache.store(
+      VerifiedJwtCache::get_digest("Bearer bob"),
+      CONFIG_VERSION,
+      identity,
+      std::nullopt,
+      get_key_version);
+
+    EXPECT_EQ(cache.size(), 0);
+  }
 }
@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "flight_recorder.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt;
+using namespace std::chrono_literals;
+
+namespace
+{
+  SlowRequest make_request(const std::string& id)
+  {
+    SlowRequest request;
+    request.request_id = id;
+    return request;
+  }
+
+  std::vector<std::string> request_ids(const FlightRecorder& recorder)
+  {
+    std::vector<std::string> ids;
+    for (const auto& request : recorder.get_recent())
+    {
+      ids.push_back(request.request_id);
+    }
+    return ids;
+  }
+
+  TEST(FlightRecorderTest, Empty)
+  {
+    FlightRecorder recorder(3);
+    EXPECT_TRUE(recorder.get_recent().empty());
+    EXPECT_EQ(recorder.get_total(), 0);
+  }
+
+  TEST(FlightRecorderTest, MostRecentFirst)
+  {
+    FlightRecorder recorder(3);
+    recorder.record(make_request("a"));
+    recorder.record(make_request("b"));
+    EXPECT_EQ(request_ids(recorder), (std::vector<std::string>{"b", "a"}));
+    EXPECT_EQ(recorder.get_total(), 2);
+  }
+
+  TEST(FlightRecorderTest, OverwritesOldest)
+  {
+    FlightRecorder recorder(3);
+    for (const auto* id : {"a", "b", "c", "d", "e"})
+    {
+      recorder.record(make_request(id));
+    }
+    EXPECT_EQ(request_ids(recorder), (std::vector<std::string>{"e", "d", "c"}));
+    EXPECT_EQ(recorder.get_total(), 5);
+  }
+
+  TEST(FlightRecorderTest, Stages)
+  {
+    timing::StageTimings timings;
+    timings.add(timing::Stage::Decode, 12us);
+    timings.add(timing::Stage::Policy, 3ms);
+
+    SlowRequest request;
+    request.set_stages(timings);
+    EXPECT_EQ(
+      request.stages_us,
+      (std::map<std::string, uint64_t>{{"Decode", 12}, {"Policy", 3000}}));
+  }
+}
@@ -117,4 +117,27 @@ namespace
       }
     }
   }
+
+  TEST(LRUTest, Erase)
+  {
+    LRU<int, int> cache(2);
+    std::vector<int> culled;
+    cache.set_cull_callback([&culled](int k, int v) { culled.push_back(k); });
+
+    cache[1] = 10;
+    cache[2] = 20;
+    cache.erase(1);
+    cache.erase(3);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_TRUE(cache.contains(2));
+
+    // Erased entries don't take up any capacity, and aren't reported as culled.
+    cache[3] = 30;
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_TRUE(culled.empty());
+
+    cache[4] = 40;
+    EXPECT_EQ(culled, std::vector<int>{2});
+  }
 }
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "indexing/catch_up_estimator.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt::indexing;
+using namespace std::chrono_literals;
+
+namespace
+{
+  TEST(CatchUpEstimatorTest, NoRateYet)
+  {
+    CatchUpEstimator estimator;
+    auto now = CatchUpEstimator::Clock::now();
+    EXPECT_EQ(
+      estimator.retry_after_seconds(100, 1000000, now),
+      CatchUpEstimator::MIN_RETRY_AFTER_SECONDS);
+    EXPECT_FALSE(estimator.get_rate().has_value());
+  }
+
+  TEST(CatchUpEstimatorTest, EstimatesFromRate)
+  {
+    CatchUpEstimator estimator;
+    auto now = CatchUpEstimator::Clock::now();
+    estimator.retry_after_seconds(0, 10000, now);
+
+    // 1000 seqnos per second, with 9000 left to go.
+    EXPECT_EQ(estimator.retry_after_seconds(1000, 10000, now + 1s), 9);
+    EXPECT_DOUBLE_EQ(estimator.get_rate().value(), 1000);
+
+    // Samples taken within the sampling interval are ignored.
+    EXPECT_EQ(estimator.retry_after_seconds(1001, 10000, now + 1100ms), 9);
+    EXPECT_DOUBLE_EQ(estimator.get_rate().value(), 1000);
+  }
+
+  TEST(CatchUpEstimatorTest, ClampsEstimate)
+  {
+    CatchUpEstimator estimator;
+    auto now = CatchUpEstimator::Clock::now();
+    estimator.retry_after_seconds(0, 1000000, now);
+
+    EXPECT_EQ(
+      estimator.retry_after_seconds(1, 1000000, now + 1s),
+      CatchUpEstimator::MAX_RETRY_AFTER_SECONDS);
+    EXPECT_EQ(
+      estimator.retry_after_seconds(999999, 1000000, now + 2s),
+      CatchUpEstimator::MIN_RETRY_AFTER_SECONDS);
+  }
+
+  TEST(CatchUpEstimatorTest, StalledIndexing)
+  {
+    CatchUpEstimator estimator;
+    auto now = CatchUpEstimator::Clock::now();
+    estimator.retry_after_seconds(500, 1000, now);
+    EXPECT_EQ(
+      estimator.retry_after_seconds(500, 1000, now + 1s),
+      CatchUpEstimator::MAX_RETRY_AFTER_SECONDS);
+  }
+
+  TEST(CatchUpEstimatorTest, IdleLedgerIsNotStalled)
+  {
+    CatchUpEstimator estimator;
+    auto now = CatchUpEstimator::Clock::now();
+    estimator.retry_after_seconds(0, 2000, now);
+    EXPECT_EQ(estimator.retry_after_seconds(1000, 2000, now + 1s), 1);
+
+    // The index catches up, and nothing happens for a while.
+    EXPECT_EQ(estimator.retry_after_seconds(2000, 2000, now + 2s), 1);
+    EXPECT_EQ(estimator.retry_after_seconds(2000, 2001, now + 60s), 1);
+    EXPECT_DOUBLE_EQ(estimator.get_rate().value(), 1000);
+  }
+}
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "indexing/entry_seqno_index.h"
+
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+using namespace scitt::indexing;
+
+namespace
+{
+  constexpr size_t SEQNOS_PER_BUCKET = 10;
+  constexpr ccf::SeqNo LAST_SEQNO = 59;
+
+  /**
+   * Stands in for CCF's bucketed index, which knows about every entry but may
+   * not have fetched them yet.
+   */
+  struct FakeFallback
+  {
+    std::set<ccf::SeqNo> seqnos;
+    bool ready = true;
+    size_t calls = 0;
+
+    std::optional<std::vector<ccf::SeqNo>> get(ccf::SeqNo from, ccf::SeqNo to)
+    {
+      calls++;
+      if (!ready)
+      {
+        return std::nullopt;
+      }
+      return std::vector<ccf::SeqNo>(
+        seqnos.lower_bound(from), seqnos.upper_bound(to));
+    }
+  };
+
+  class TestIndex : public EntrySeqnoIndexingStrategy
+  {
+  public:
+    TestIndex(FakeFallback& fallback, size_t max_resident_bytes) :
+      EntrySeqnoIndexingStrategy(
+        [&fallback](ccf::SeqNo from, ccf::SeqNo to) {
+          return fallback.get(from, to);
+        },
+        SEQNOS_PER_BUCKET,
+        max_resident_bytes)
+    {
+      // Every seqno but multiples of 3 is an entry, such that buckets are
+      // neither empty nor full.
+      for (ccf::SeqNo seqno = 1; seqno <= LAST_SEQNO; seqno++)
+      {
+        if (seqno % 3 != 0)
+        {
+          fallback.seqnos.insert(seqno);
+          visit_entry({2, seqno}, {}, {});
+        }
+      }
+    }
+  };
+
+  void check_all_ranges(
+    const TestIndex& index, const std::set<ccf::SeqNo>& expected)
+  {
+    for (ccf::SeqNo from = 0; from <= LAST_SEQNO + 5; from++)
+    {
+      for (ccf::SeqNo to = from; to <= LAST_SEQNO + 5; to++)
+      {
+        const std::vector<ccf::SeqNo> seqnos(
+          expected.lower_bound(from), expected.upper_bound(to));
+        EXPECT_EQ(index.get_write_txs_in_range(from, to), seqnos)
+          << from << "-" << to;
+        EXPECT_EQ(index.count_write_txs_in_range(from, to), seqnos.size())
+          << from << "-" << to;
+      }
+    }
+  }
+
+  TEST(EntrySeqnoIndexTest, AllResident)
+  {
+    FakeFallback fallback;
+    TestIndex index(fallback, 1024 * 1024);
+
+    check_all_ranges(index, fallback.seqnos);
+    EXPECT_EQ(fallback.calls, 0);
+  }
+
+  TEST(EntrySeqnoIndexTest, StraddlingRanges)
+  {
+    FakeFallback fallback;
+    TestIndex index(fallback, 1024 * 1024);
+
+    // Ranges which cross a bucket boundary without covering a whole bucket
+    EXPECT_EQ(index.count_write_txs_in_range(9, 11), 2);
+    EXPECT_EQ(index.count_write_txs_in_range(8, 17), 7);
+    EXPECT_EQ(index.count_write_txs_in_range(19, 20), 2);
+  }
+
+  TEST(EntrySeqnoIndexTest, Eviction)
+  {
+    FakeFallback fallback;
+    // Only the most recent bucket fits
+    TestIndex index(fallback, 0);
+
+    EXPECT_EQ(
+      index.describe()["resident_from_seqno"],
+      (LAST_SEQNO / SEQNOS_PER_BUCKET) * SEQNOS_PER_BUCKET);
+    EXPECT_GT(index.get_resident_bytes(), 0);
+
+    // Evicted buckets are served by the fallback, and counted from the
+    // per-bucket totals where possible.
+    check_all_ranges(index, fallback.seqnos);
+    EXPECT_GT(fallback.calls, 0);
+
+    fallback.calls = 0;
+    EXPECT_EQ(index.count_write_txs_in_range(10, 39), 20);
+    EXPECT_EQ(fallback.calls, 0);
+  }
+
+  TEST(EntrySeqnoIndexTest, FallbackNotReady)
+  {
+    FakeFallback fallback;
+    TestIndex index(fallback, 0);
+    fallback.ready = false;
+
+    EXPECT_EQ(index.get_write_txs_in_range(0, LAST_SEQNO), std::nullopt);
+    EXPECT_EQ(index.count_write_txs_in_range(5, LAST_SEQNO), std::nullopt);
+    EXPECT_EQ(index.count_write_txs_in_range(9, 11), std::nullopt);
+
+    // Whole buckets and resident ones don't need the fallback
+    EXPECT_EQ(index.count_write_txs_in_range(0, 39), 26);
+    EXPECT_EQ(index.get_write_txs_in_range(50, 52).value().size(), 2);
+  }
+}
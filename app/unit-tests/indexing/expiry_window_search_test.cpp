@@ -0,0 +1,227 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "indexing/expiry_window_search.h"
+
+#include <gtest/gtest.h>
+#include <rapidcheck.h>
+#include <rapidcheck/gtest.h>
+#include <set>
+#include <vector>
+
+using namespace scitt::indexing;
+
+namespace
+{
+  // The creation time of the operation recorded at each sequence number, if
+  // any.
+  using Ledger = std::vector<std::optional<time_t>>;
+
+  struct SearchResult
+  {
+    ccf::SeqNo start;
+    size_t probes;
+  };
+
+  SearchResult run_search(const Ledger& ledger, time_t cutoff)
+  {
+    ExpiryWindowSearch search(0, ledger.size(), cutoff);
+    size_t probes = 0;
+    while (!search.done())
+    {
+      auto seqno = search.next_probe();
+      search.record(seqno, ledger.at(seqno));
+      probes++;
+    }
+    return {search.result(), probes};
+  }
+
+  /**
+   * Run a search which skips to the next write to the operations table before
+   * each probe, as the operations index does. Writes include those of
+   * transactions which complete an operation rather than record a new one.
+   */
+  SearchResult run_indexed_search(
+    const Ledger& ledger, const std::set<ccf::SeqNo>& writes, time_t cutoff)
+  {
+    ExpiryWindowSearch search(0, ledger.size(), cutoff);
+    size_t probes = 0;
+    while (!search.done())
+    {
+      auto it = writes.lower_bound(search.next_probe());
+      search.skip_to(it != writes.end() ? *it : ledger.size());
+      if (search.done())
+      {
+        break;
+      }
+
+      auto seqno = search.next_probe();
+      search.record(seqno, ledger.at(seqno));
+      probes++;
+    }
+    return {search.result(), probes};
+  }
+
+  std::set<ccf::SeqNo> get_writes(const Ledger& ledger)
+  {
+    std::set<ccf::SeqNo> writes;
+    for (size_t i = 0; i < ledger.size(); i++)
+    {
+      if (ledger[i].has_value())
+      {
+        writes.insert(i);
+      }
+    }
+    return writes;
+  }
+
+  /**
+   * Check that indexing from start would not miss any operation created at or
+   * after the cutoff, nor index any created before it.
+   */
+  void check_start(const Ledger& ledger, time_t cutoff, ccf::SeqNo start)
+  {
+    for (size_t i = 0; i < ledger.size(); i++)
+    {
+      if (ledger[i].has_value())
+      {
+        EXPECT_EQ(i >= start, ledger[i].value() >= cutoff) << "at " << i;
+      }
+    }
+  }
+
+  TEST(ExpiryWindowSearchTest, EmptyLedger)
+  {
+    ExpiryWindowSearch search(0, 0, 100);
+    EXPECT_TRUE(search.done());
+    EXPECT_EQ(search.result(), 0);
+  }
+
+  TEST(ExpiryWindowSearchTest, DenseLedger)
+  {
+    Ledger ledger;
+    for (time_t t = 0; t < 100000; t++)
+    {
+      ledger.push_back(t);
+    }
+
+    auto result = run_search(ledger, 75000);
+    EXPECT_EQ(result.start, 75000);
+    EXPECT_LE(result.probes, 20);
+  }
+
+  TEST(ExpiryWindowSearchTest, SparseLedger)
+  {
+    // One operation every 10 transactions, one second apart.
+    Ledger ledger(100000);
+    for (size_t i = 5; i < ledger.size(); i += 10)
+    {
+      ledger[i] = i / 10;
+    }
+
+    auto result = run_search(ledger, 1234);
+    check_start(ledger, 1234, result.start);
+    EXPECT_LE(result.probes, 20 * 10);
+  }
+
+  TEST(ExpiryWindowSearchTest, VerySparseLedger)
+  {
+    // Operation logs are only written once per clock tick, or not at all
+    // while the ledger is idle, so they can be thousands of transactions
+    // apart.
+    Ledger ledger(1000000);
+    for (size_t i = 5000; i < ledger.size(); i += 10000)
+    {
+      ledger[i] = i / 10000;
+    }
+    auto writes = get_writes(ledger);
+
+    auto result = run_indexed_search(ledger, writes, 42);
+    check_start(ledger, 42, result.start);
+    EXPECT_LE(result.probes, 2 * 20);
+
+    // Operations are completed in transactions of their own, which write to
+    // the operations table without recording a new operation.
+    for (size_t i = 7000; i < ledger.size(); i += 10000)
+    {
+      writes.insert(i);
+    }
+    result = run_indexed_search(ledger, writes, 42);
+    check_start(ledger, 42, result.start);
+    EXPECT_LE(result.probes, 3 * 20);
+  }
+
+  TEST(ExpiryWindowSearchTest, SkipTo)
+  {
+    ExpiryWindowSearch search(0, 100, 10);
+    auto probe = search.next_probe();
+
+    // Skipping backwards does nothing
+    search.skip_to(probe - 1);
+    EXPECT_EQ(search.next_probe(), probe);
+
+    search.skip_to(probe + 10);
+    EXPECT_EQ(search.next_probe(), probe + 10);
+    EXPECT_EQ(search.probe_end(), 100);
+
+    // Nothing left until the end of the interval, so the search moves on to
+    // its first half.
+    search.skip_to(100);
+    EXPECT_EQ(search.probe_end(), probe);
+    EXPECT_LT(search.next_probe(), probe);
+  }
+
+  TEST(ExpiryWindowSearchTest, NothingRecent)
+  {
+    Ledger ledger(1000);
+    ledger[10] = 1;
+    ledger[500] = 2;
+
+    auto result = run_search(ledger, 100);
+    check_start(ledger, 100, result.start);
+  }
+
+  TEST(ExpiryWindowSearchTest, IgnoresOtherSeqnos)
+  {
+    ExpiryWindowSearch search(0, 100, 10);
+    auto probe = search.next_probe();
+    search.record(probe + 1, 0);
+    EXPECT_EQ(search.next_probe(), probe);
+  }
+
+  RC_GTEST_PROP(
+    ExpiryWindowSearchTest,
+    finds_window_start,
+    (const std::vector<uint8_t>& steps, uint8_t cutoff))
+  {
+    // Steps that are multiples of 3 leave a transaction without operation.
+    // Others advance the clock by a small amount.
+    Ledger ledger;
+    time_t now = 0;
+    for (auto step : steps)
+    {
+      if (step % 3 == 0)
+      {
+        ledger.push_back(std::nullopt);
+      }
+      else
+      {
+        now += step % 5;
+        ledger.push_back(now);
+      }
+    }
+
+    auto result = run_search(ledger, cutoff);
+    auto indexed_result =
+      run_indexed_search(ledger, get_writes(ledger), cutoff);
+    for (size_t i = 0; i < ledger.size(); i++)
+    {
+      if (ledger[i].has_value())
+      {
+        RC_ASSERT((i >= result.start) == (ledger[i].value() >= cutoff));
+        RC_ASSERT(
+          (i >= indexed_result.start) == (ledger[i].value() >= cutoff));
+      }
+    }
+  }
+}
@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "indexing/operation_waiters.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace scitt::indexing;
+using namespace std::chrono_literals;
+
+namespace
+{
+  class OperationWaitersTest : public ::testing::Test
+  {
+  protected:
+    void add(ccf::SeqNo seqno, OperationWaiters::Clock::time_point deadline)
+    {
+      EXPECT_TRUE(waiters.add(
+        seqno, deadline, [this, seqno] { completed.push_back(seqno); }));
+    }
+
+    std::vector<ccf::SeqNo> take()
+    {
+      completed.clear();
+      for (auto& callback : waiters.take_completed())
+      {
+        callback();
+      }
+      return completed;
+    }
+
+    OperationWaiters waiters{4};
+    std::vector<ccf::SeqNo> completed;
+    OperationWaiters::Clock::time_point now =
+      OperationWaiters::Clock::now();
+  };
+
+  TEST_F(OperationWaitersTest, Complete)
+  {
+    add(10, now + 1s);
+    add(10, now + 1s);
+    add(11, now + 1s);
+
+    waiters.complete(12);
+    EXPECT_TRUE(take().empty());
+
+    waiters.complete(10);
+    EXPECT_EQ(take(), (std::vector<ccf::SeqNo>{10, 10}));
+    EXPECT_EQ(waiters.size(), 1);
+
+    // Callbacks are only run once
+    waiters.complete(10);
+    EXPECT_TRUE(take().empty());
+  }
+
+  TEST_F(OperationWaitersTest, CompleteRange)
+  {
+    add(10, now + 1s);
+    add(11, now + 1s);
+    add(12, now + 1s);
+
+    waiters.complete_range(11, 11);
+    EXPECT_TRUE(take().empty());
+
+    waiters.complete_range(0, 12);
+    EXPECT_EQ(take(), (std::vector<ccf::SeqNo>{10, 11}));
+    EXPECT_EQ(waiters.size(), 1);
+  }
+
+  TEST_F(OperationWaitersTest, Expire)
+  {
+    add(10, now + 2s);
+    add(11, now + 1s);
+
+    waiters.complete_expired(now);
+    EXPECT_TRUE(take().empty());
+
+    waiters.complete_expired(now + 1s);
+    EXPECT_EQ(take(), (std::vector<ccf::SeqNo>{11}));
+
+    waiters.complete_expired(now + 1h);
+    EXPECT_EQ(take(), (std::vector<ccf::SeqNo>{10}));
+    EXPECT_EQ(waiters.size(), 0);
+  }
+
+  TEST_F(OperationWaitersTest, Bounded)
+  {
+    for (ccf::SeqNo seqno = 0; seqno < 4; seqno++)
+    {
+      add(seqno, now + 1s);
+    }
+    EXPECT_FALSE(waiters.add(4, now + 1s, [] { FAIL(); }));
+
+    // Completing waiters makes room for new ones
+    waiters.complete(0);
+    add(4, now + 1s);
+    EXPECT_EQ(waiters.size(), 4);
+  }
+}
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "indexing/seqno_posting_list.h"
+
+#include <gtest/gtest.h>
+#include <rapidcheck.h>
+#include <rapidcheck/gtest.h>
+#include <set>
+#include <vector>
+
+using namespace scitt::indexing;
+
+namespace
+{
+  /**
+   * Turn a list of gaps into a strictly increasing list of sequence numbers,
+   * starting from base. Small gaps are more likely, such that the generated
+   * lists contain runs of consecutive sequence numbers.
+   */
+  std::vector<ccf::SeqNo> make_seqnos(
+    ccf::SeqNo base, const std::vector<uint16_t>& gaps)
+  {
+    std::vector<ccf::SeqNo> seqnos;
+    ccf::SeqNo current = base;
+    for (auto gap : gaps)
+    {
+      current += (gap % 4 == 0) ? gap : 1;
+      seqnos.push_back(current);
+    }
+    return seqnos;
+  }
+
+  TEST(SeqNoPostingListTest, Empty)
+  {
+    SeqNoPostingList list(100);
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(list.size(), 0);
+    EXPECT_EQ(list.count_in_range(0, 1000), 0);
+  }
+
+  TEST(SeqNoPostingListTest, DenseRunsAreSmall)
+  {
+    SeqNoPostingList list(0);
+    for (ccf::SeqNo seqno = 0; seqno < 10000; seqno++)
+    {
+      // Leave a hole every 100 transactions, as signatures would.
+      if (seqno % 100 != 0)
+      {
+        list.append(seqno);
+      }
+    }
+    list.shrink_to_fit();
+
+    EXPECT_EQ(list.size(), 9900);
+    EXPECT_EQ(list.count_in_range(0, 99), 99);
+    EXPECT_EQ(list.count_in_range(100, 100), 0);
+    EXPECT_EQ(list.count_in_range(150, 250), 100);
+    EXPECT_LT(list.size_bytes(), 1024);
+  }
+
+  TEST(SeqNoPostingListTest, RejectsOutOfOrderAppends)
+  {
+    SeqNoPostingList list(10);
+    list.append(12);
+    EXPECT_THROW(list.append(12), std::logic_error);
+    EXPECT_THROW(list.append(11), std::logic_error);
+    list.append(20);
+    EXPECT_THROW(list.append(15), std::logic_error);
+  }
+
+  TEST(SeqNoPostingListTest, SeeksToRange)
+  {
+    // Every other sequence number, such that each one is its own run.
+    SeqNoPostingList list(0);
+    std::set<ccf::SeqNo> seqnos;
+    for (ccf::SeqNo seqno = 0; seqno < 100000; seqno += 2)
+    {
+      list.append(seqno);
+      seqnos.insert(seqno);
+    }
+
+    for (ccf::SeqNo from : {0, 1, 127, 128, 129, 5000, 99998, 99999})
+    {
+      size_t visited = 0;
+      list.for_each_run(from, [&](ccf::SeqNo start, size_t length) {
+        visited++;
+        return start + length <= from;
+      });
+      EXPECT_LE(visited, SeqNoPostingList::SKIP_INTERVAL + 1) << from;
+
+      const ccf::SeqNo to = from + 300;
+      const auto expected = std::distance(
+        seqnos.lower_bound(from), seqnos.upper_bound(to));
+      EXPECT_EQ(list.count_in_range(from, to), expected) << from;
+    }
+  }
+
+  RC_GTEST_PROP(
+    SeqNoPostingListTest,
+    matches_set,
+    (ccf::SeqNo base,
+     const std::vector<uint16_t>& gaps,
+     uint16_t from_offset,
+     uint16_t length))
+  {
+    RC_PRE(base < (1ull << 48));
+    const auto seqnos = make_seqnos(base, gaps);
+
+    SeqNoPostingList list(base);
+    for (auto seqno : seqnos)
+    {
+      list.append(seqno);
+    }
+    RC_ASSERT(list.size() == seqnos.size());
+
+    const ccf::SeqNo from = base + from_offset;
+    const ccf::SeqNo to = from + length;
+
+    std::vector<ccf::SeqNo> expected;
+    std::copy_if(
+      seqnos.begin(),
+      seqnos.end(),
+      std::back_inserter(expected),
+      [&](ccf::SeqNo seqno) { return from <= seqno && seqno <= to; });
+
+    std::vector<ccf::SeqNo> actual;
+    list.for_each_in_range(
+      from, to, [&actual](ccf::SeqNo seqno) { actual.push_back(seqno); });
+
+    RC_ASSERT(actual == expected);
+    RC_ASSERT(list.count_in_range(from, to) == expected.size());
+  }
+}
@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "indexing/seqno_ring.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <rapidcheck.h>
+#include <rapidcheck/gtest.h>
+#include <vector>
+
+using namespace scitt::indexing;
+
+namespace
+{
+  struct State
+  {
+    int64_t created_at = 0;
+    uint64_t view = 0;
+  };
+
+  TEST(SeqNoRingTest, Empty)
+  {
+    SeqNoRing<int> ring;
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.find(1), nullptr);
+    EXPECT_EQ(ring.lower_bound(1), 0);
+    EXPECT_THROW(ring.pop_front(), std::logic_error);
+  }
+
+  TEST(SeqNoRingTest, PushFindPop)
+  {
+    SeqNoRing<int> ring;
+    for (ccf::SeqNo seqno = 10; seqno < 1000; seqno += 2)
+    {
+      ring.push_back(seqno, static_cast<int>(seqno * 3));
+    }
+    EXPECT_EQ(ring.size(), 495);
+    EXPECT_EQ(*ring.find(10), 30);
+    EXPECT_EQ(*ring.find(998), 2994);
+    EXPECT_EQ(ring.find(11), nullptr);
+    EXPECT_EQ(ring.find(1000), nullptr);
+
+    *ring.find(500) = -1;
+    EXPECT_EQ(*ring.find(500), -1);
+
+    while (ring.front().seqno < 900)
+    {
+      ring.pop_front();
+    }
+    EXPECT_EQ(ring.size(), 50);
+    EXPECT_EQ(ring.find(500), nullptr);
+    EXPECT_EQ(*ring.find(900), 2700);
+  }
+
+  TEST(SeqNoRingTest, RejectsOutOfOrderInserts)
+  {
+    SeqNoRing<int> ring;
+    ring.push_back(5, 0);
+    EXPECT_THROW(ring.push_back(5, 0), std::logic_error);
+    EXPECT_THROW(ring.push_back(4, 0), std::logic_error);
+  }
+
+  TEST(SeqNoRingTest, ShrinksAfterPurge)
+  {
+    SeqNoRing<State> ring;
+    for (ccf::SeqNo seqno = 0; seqno < 100000; seqno++)
+    {
+      ring.push_back(seqno, {});
+    }
+    const auto full_size = ring.size_bytes();
+    while (ring.size() > 10)
+    {
+      ring.pop_front();
+    }
+    EXPECT_LT(ring.size_bytes(), full_size / 100);
+  }
+
+  RC_GTEST_PROP(
+    SeqNoRingTest,
+    matches_map,
+    (const std::vector<std::pair<bool, uint8_t>>& ops))
+  {
+    SeqNoRing<uint64_t> ring;
+    std::map<ccf::SeqNo, uint64_t> map;
+    ccf::SeqNo next = 1;
+
+    // Each operation either pushes a new entry, some distance after the last
+    // one, or pops from the front.
+    for (const auto& [push, n] : ops)
+    {
+      if (push || map.empty())
+      {
+        next += n;
+        ring.push_back(next, n);
+        map.emplace(next, n);
+        next++;
+      }
+      else
+      {
+        ring.pop_front();
+        map.erase(map.begin());
+      }
+
+      RC_ASSERT(ring.size() == map.size());
+      for (ccf::SeqNo seqno = 0; seqno <= next; seqno++)
+      {
+        auto it = map.find(seqno);
+        auto* value = ring.find(seqno);
+        RC_ASSERT((it != map.end()) == (value != nullptr));
+        if (value != nullptr)
+        {
+          RC_ASSERT(*value == it->second);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "issuer_costs.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt;
+using namespace std::chrono_literals;
+
+namespace
+{
+  TEST(HeavyHittersTest, TracksUpToCapacity)
+  {
+    HeavyHitters sketch(2);
+    sketch.add("a", 10, 100);
+    sketch.add("b", 20, 200);
+    sketch.add("a", 5, 50);
+
+    const auto& entries = sketch.get_entries();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries.at("a").count, 2);
+    EXPECT_EQ(entries.at("a").cpu_us, 15);
+    EXPECT_EQ(entries.at("a").bytes, 150);
+    EXPECT_EQ(entries.at("a").error_us, 0);
+  }
+
+  TEST(HeavyHittersTest, ReplacesSmallest)
+  {
+    HeavyHitters sketch(2);
+    sketch.add("a", 10, 100);
+    sketch.add("b", 20, 200);
+    sketch.add("c", 1, 1);
+
+    const auto& entries = sketch.get_entries();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries.count("a"), 0);
+    EXPECT_EQ(entries.at("b").cpu_us, 20);
+    EXPECT_EQ(entries.at("c").count, 2);
+    EXPECT_EQ(entries.at("c").cpu_us, 11);
+    EXPECT_EQ(entries.at("c").error_us, 10);
+  }
+
+  TEST(HeavyHittersTest, HeavyHitterIsKept)
+  {
+    HeavyHitters sketch(4);
+    for (int i = 0; i < 1000; i++)
+    {
+      sketch.add("noisy", 100, 0);
+      sketch.add(std::to_string(i), 1, 0);
+    }
+
+    const auto& entries = sketch.get_entries();
+    ASSERT_EQ(entries.count("noisy"), 1);
+    EXPECT_EQ(entries.at("noisy").cpu_us, 100000);
+  }
+
+  TEST(IssuerCostTrackerTest, TopN)
+  {
+    IssuerCostTracker tracker;
+    auto now = IssuerCostTracker::Clock::now();
+    tracker.record("a", 1ms, 10, now);
+    tracker.record("b", 3ms, 10, now);
+    tracker.record("c", 2ms, 10, now);
+
+    auto top = tracker.top(2, 1, now);
+    ASSERT_EQ(top.size(), 2);
+    EXPECT_EQ(top[0].issuer, "b");
+    EXPECT_EQ(top[0].cpu_us, 3000);
+    EXPECT_EQ(top[1].issuer, "c");
+  }
+
+  TEST(IssuerCostTrackerTest, LongIssuer)
+  {
+    IssuerCostTracker tracker;
+    auto now = IssuerCostTracker::Clock::now();
+    tracker.record(std::string(1000, 'a'), 1ms, 10, now);
+
+    auto top = tracker.top(1, 1, now);
+    ASSERT_EQ(top.size(), 1);
+    EXPECT_EQ(top[0].issuer.size(), IssuerCostTracker::MAX_ISSUER_LENGTH);
+  }
+
+  TEST(IssuerCostTrackerTest, Windows)
+  {
+    IssuerCostTracker tracker;
+    auto now = IssuerCostTracker::Clock::now();
+    auto earlier = now - 5 * IssuerCostTracker::WINDOW_DURATION;
+    tracker.record("a", 1ms, 10, earlier);
+    tracker.record("a", 2ms, 20, now);
+
+    auto current = tracker.top(10, 1, now);
+    ASSERT_EQ(current.size(), 1);
+    EXPECT_EQ(current[0].cpu_us, 2000);
+
+    auto recent = tracker.top(10, 10, now);
+    ASSERT_EQ(recent.size(), 1);
+    EXPECT_EQ(recent[0].count, 2);
+    EXPECT_EQ(recent[0].cpu_us, 3000);
+    EXPECT_EQ(recent[0].bytes, 30);
+
+    // Windows older than the tracked period are dropped when their slot is
+    // reused.
+    auto later = now + IssuerCostTracker::WINDOW_COUNT *
+      IssuerCostTracker::WINDOW_DURATION;
+    tracker.record("b", 1ms, 10, later);
+    auto after = tracker.top(10, IssuerCostTracker::WINDOW_COUNT, later);
+    ASSERT_EQ(after.size(), 1);
+    EXPECT_EQ(after[0].issuer, "b");
+  }
+}
@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "metrics.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace scitt::metrics;
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace
+{
+  TEST(MetricsTest, HistogramBuckets)
+  {
+    EXPECT_EQ(Histogram::bucket_index(uint64_t{0}), 0);
+    EXPECT_EQ(Histogram::bucket_index(uint64_t{1}), 0);
+    EXPECT_EQ(Histogram::bucket_index(uint64_t{2}), 1);
+    EXPECT_EQ(Histogram::bucket_index(uint64_t{3}), 1);
+    EXPECT_EQ(Histogram::bucket_index(uint64_t{4}), 2);
+    EXPECT_EQ(Histogram::bucket_index(1023us), 9);
+    EXPECT_EQ(Histogram::bucket_index(1024us), 10);
+    EXPECT_EQ(Histogram::bucket_index(24h), Histogram::BUCKET_COUNT - 1);
+    EXPECT_EQ(Histogram::bucket_index(-1s), 0);
+
+    for (size_t i = 0; i < Histogram::BUCKET_COUNT - 1; i++)
+    {
+      auto bound = Histogram::bucket_upper_bound(i);
+      EXPECT_EQ(Histogram::bucket_index(bound), i);
+      EXPECT_EQ(Histogram::bucket_index(bound + 1), i + 1);
+    }
+  }
+
+  TEST(MetricsTest, HistogramRecord)
+  {
+    Histogram histogram;
+    histogram.record(1us);
+    histogram.record(5us);
+    histogram.record(uint64_t{6});
+
+    EXPECT_EQ(histogram.get_count(), 3);
+    EXPECT_EQ(histogram.get_sum(), 12);
+    EXPECT_EQ(histogram.get_bucket(0), 1);
+    EXPECT_EQ(histogram.get_bucket(1), 0);
+    EXPECT_EQ(histogram.get_bucket(2), 2);
+  }
+
+  TEST(MetricsTest, RegistrationIsIdempotent)
+  {
+    Registry registry;
+    auto& a = registry.counter("requests_total", "Requests", {{"path", "/a"}});
+    auto& b = registry.counter("requests_total", "Requests", {{"path", "/b"}});
+    auto& a2 = registry.counter("requests_total", "Requests", {{"path", "/a"}});
+
+    EXPECT_EQ(&a, &a2);
+    EXPECT_NE(&a, &b);
+
+    EXPECT_THROW(
+      registry.gauge("requests_total", "Requests"), std::logic_error);
+  }
+
+  TEST(MetricsTest, Prometheus)
+  {
+    Registry registry;
+    registry.counter("requests_total", "Requests", {{"path", "/a"}})
+      .increment(3);
+    registry.gauge("queue_depth", "Queue depth").set(-2);
+    registry.callback_gauge(
+      "cache_size", "Cache size", {{"name", "x\"y"}}, [] { return 1.5; });
+    auto& histogram = registry.histogram(
+      "duration_seconds", "Duration", {{"stage", "s"}}, MICROSECONDS);
+    histogram.record(1us);
+    histogram.record(3us);
+
+    auto text = registry.to_prometheus();
+    EXPECT_THAT(
+      text,
+      HasSubstr("# HELP requests_total Requests\n"
+                "# TYPE requests_total counter\n"
+                "requests_total{path=\"/a\"} 3\n"));
+    EXPECT_THAT(
+      text,
+      HasSubstr("# TYPE queue_depth gauge\n"
+                "queue_depth -2\n"));
+    EXPECT_THAT(text, HasSubstr("cache_size{name=\"x\\\"y\"} 1.5\n"));
+    EXPECT_THAT(
+      text,
+      HasSubstr("# TYPE duration_seconds histogram\n"
+                "duration_seconds_bucket{stage=\"s\",le=\"1e-06\"} 1\n"
+                "duration_seconds_bucket{stage=\"s\",le=\"3e-06\"} 2\n"
+                "duration_seconds_bucket{stage=\"s\",le=\"7e-06\"} 2\n"));
+    EXPECT_THAT(
+      text,
+      HasSubstr("duration_seconds_bucket{stage=\"s\",le=\"+Inf\"} 2\n"
+                "duration_seconds_sum{stage=\"s\"} 4e-06\n"
+                "duration_seconds_count{stage=\"s\"} 2\n"));
+  }
+}
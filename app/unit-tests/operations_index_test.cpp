@@ -0,0 +1,384 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "operations_endpoints.h"
+
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+
+using namespace scitt;
+
+namespace
+{
+  /**
+   * An operations index fed directly with the contents of the operations
+   * table, rather than by CCF's indexer.
+   */
+  class TestIndex : public OperationsIndexingStrategy
+  {
+  public:
+    TestIndex() :
+      OperationsIndexingStrategy(
+        [this](timespec& time) {
+          time.tv_sec = now;
+          time.tv_nsec = 0;
+          return ccf::ApiResult::OK;
+        },
+        [this](ccf::View, ccf::SeqNo, ccf::TxStatus& tx_status) {
+          tx_status = ccf::TxStatus::Committed;
+          return tx_status_result;
+        },
+        [this](ccf::SeqNo& seqno) {
+          seqno = committed_seqno;
+          return ccf::ApiResult::OK;
+        },
+        [this](ccf::SeqNo from, ccf::SeqNo to) {
+          return find_operation_logs(from, to);
+        })
+    {}
+
+    using OperationsIndexingStrategy::visit_entry;
+    using OperationsIndexingStrategy::visit_search_probe;
+    using OperationsIndexingStrategy::visit_synchronous_entry;
+
+    time_t now = 0;
+    ccf::SeqNo committed_seqno = 0;
+    ccf::ApiResult tx_status_result = ccf::ApiResult::OK;
+    FindOperationLogs find_operation_logs =
+      [](ccf::SeqNo, ccf::SeqNo) -> std::optional<std::vector<ccf::SeqNo>> {
+      return std::nullopt;
+    };
+  };
+
+  OperationLog running(time_t created_at)
+  {
+    return OperationLog{
+      .status = OperationStatus::Running,
+      .operation_id = {},
+      .created_at = created_at,
+      .context_digest = {},
+      .error = {}};
+  }
+
+  OperationLog succeeded(
+    std::optional<ccf::TxID> operation_id, std::optional<time_t> created_at)
+  {
+    return OperationLog{
+      .status = OperationStatus::Succeeded,
+      .operation_id = operation_id,
+      .created_at = created_at,
+      .context_digest = {},
+      .error = {}};
+  }
+
+  void expect_succeeded(TestIndex& index, const ccf::TxID& operation_id)
+  {
+    const auto operation = index.lookup(operation_id);
+    EXPECT_EQ(operation.status, OperationStatus::Succeeded);
+    EXPECT_EQ(operation.entry_id, operation_id);
+  }
+
+  void expect_expired(TestIndex& index, const ccf::TxID& operation_id)
+  {
+    try
+    {
+      index.lookup(operation_id);
+      FAIL() << "Expected operation " << operation_id.to_str()
+             << " to have expired";
+    }
+    catch (const HTTPError& e)
+    {
+      EXPECT_EQ(e.code, errors::OperationExpired);
+    }
+  }
+
+  OperationLog failed(const ccf::TxID& operation_id, nlohmann::json error)
+  {
+    return OperationLog{
+      .status = OperationStatus::Failed,
+      .operation_id = operation_id,
+      .created_at = {},
+      .context_digest = {},
+      .error = std::move(error)};
+  }
+
+  TEST(OperationsIndexTest, Errors)
+  {
+    TestIndex index;
+    const auto fail = [&index](ccf::SeqNo seqno, nlohmann::json error) {
+      index.visit_entry({2, seqno}, running(100));
+      index.visit_entry({2, seqno + 1}, failed({2, seqno}, std::move(error)));
+      const auto operation = index.lookup({2, seqno});
+      EXPECT_EQ(operation.status, OperationStatus::Failed);
+      return operation.error;
+    };
+
+    EXPECT_EQ(
+      fail(10, {{"code", "Boom"}, {"message", "Something went wrong"}}),
+      (ODataError{.code = "Boom", .message = "Something went wrong"}));
+
+    // Errors lacking some fields, for instance because they were recorded by
+    // an older version of the service, don't stop the index.
+    EXPECT_EQ(
+      fail(20, {{"message", "Something went wrong"}}),
+      (ODataError{
+        .code = errors::InternalError, .message = "Something went wrong"}));
+    EXPECT_EQ(
+      fail(30, "Something went wrong"),
+      (ODataError{
+        .code = errors::InternalError, .message = "\"Something went wrong\""}));
+  }
+
+  TEST(OperationsIndexTest, ExpiryOnIdleLedger)
+  {
+    TestIndex index;
+    index.now = 1000;
+    index.visit_entry({2, 10}, running(1000));
+    EXPECT_EQ(index.lookup({2, 10}).status, OperationStatus::Running);
+
+    // No transaction comes after the operation, but time passes on the host
+    index.now += OPERATION_EXPIRY.count() + 60 * 60;
+    index.tick();
+
+    expect_expired(index, {2, 10});
+    EXPECT_EQ(index.describe()["purged_operations"], 1);
+  }
+
+  TEST(OperationsIndexTest, SynchronousOperationsFromEntries)
+  {
+    TestIndex index;
+
+    // Only the first entry after each clock tick records the time
+    index.visit_entry({2, 10}, succeeded({}, 1000));
+    index.visit_synchronous_entry({2, 11});
+    index.visit_synchronous_entry({2, 12});
+    index.visit_entry({2, 20}, succeeded({}, 2000));
+    index.visit_synchronous_entry({2, 21});
+
+    for (ccf::SeqNo seqno : {10, 11, 12, 20, 21})
+    {
+      expect_succeeded(index, {2, seqno});
+    }
+    // Transactions which didn't write an entry aren't operations
+    EXPECT_THROW(index.lookup({2, 15}), HTTPError);
+
+    // Entries without a time of their own are as old as the tick before them
+    index.visit_entry(
+      {2, 30}, succeeded({}, 1000 + OPERATION_EXPIRY.count() + 60));
+    for (ccf::SeqNo seqno : {10, 11, 12})
+    {
+      expect_expired(index, {2, seqno});
+    }
+    for (ccf::SeqNo seqno : {20, 21, 30})
+    {
+      expect_succeeded(index, {2, seqno});
+    }
+  }
+
+  TEST(OperationsIndexTest, OperationLogForEveryEntry)
+  {
+    TestIndex index;
+
+    // Older ledgers record the time of every synchronous operation, alongside
+    // the logs of asynchronous ones.
+    index.visit_entry({2, 10}, succeeded({}, 1000));
+    index.visit_entry({2, 11}, running(1001));
+    index.visit_entry({2, 12}, succeeded({}, 1002));
+    index.visit_entry({2, 13}, succeeded(ccf::TxID{2, 11}, {}));
+    index.visit_entry({2, 14}, succeeded({}, 1200));
+
+    expect_succeeded(index, {2, 10});
+    expect_succeeded(index, {2, 12});
+    expect_succeeded(index, {2, 14});
+    const auto operation = index.lookup({2, 11});
+    EXPECT_EQ(operation.status, OperationStatus::Succeeded);
+    EXPECT_EQ(operation.entry_id, (ccf::TxID{2, 13}));
+
+    index.visit_entry(
+      {2, 20}, succeeded({}, 1050 + OPERATION_EXPIRY.count() + 60));
+    expect_expired(index, {2, 10});
+    expect_expired(index, {2, 11});
+    expect_expired(index, {2, 12});
+    expect_succeeded(index, {2, 14});
+  }
+
+  TEST(OperationsIndexTest, WaitForOperation)
+  {
+    TestIndex index;
+    std::vector<std::string> outcomes;
+    using Clock = indexing::OperationWaiters::Clock;
+    const auto wait = [&](ccf::TxID operation_id, Clock::time_point deadline) {
+      return index.wait_for(operation_id, deadline, [&, operation_id] {
+        try
+        {
+          outcomes.push_back(
+            operationStatusToString(index.lookup(operation_id).status));
+        }
+        catch (const HTTPError& e)
+        {
+          outcomes.push_back(e.code);
+        }
+      });
+    };
+    const auto now = Clock::now();
+    const auto later = now + std::chrono::hours(1);
+
+    // Requests wait for operations which haven't been indexed yet, and for
+    // those which are still running.
+    EXPECT_TRUE(wait({2, 10}, later));
+    index.visit_entry({2, 10}, running(1000));
+    EXPECT_TRUE(wait({2, 10}, later));
+    EXPECT_TRUE(wait({2, 13}, later));
+    index.tick();
+    EXPECT_TRUE(outcomes.empty());
+
+    index.visit_entry({2, 11}, succeeded(ccf::TxID{2, 10}, {}));
+    EXPECT_TRUE(outcomes.empty());
+    index.tick();
+    EXPECT_EQ(outcomes, (std::vector<std::string>{"succeeded", "succeeded"}));
+    outcomes.clear();
+
+    // Completed operations are returned straight away
+    EXPECT_FALSE(wait({2, 10}, later));
+
+    // Transactions which turn out not to be operations stop waiting as soon
+    // as the index goes past them.
+    index.visit_synchronous_entry({2, 14});
+    index.tick();
+    EXPECT_EQ(outcomes, (std::vector<std::string>{errors::NotFound}));
+    outcomes.clear();
+
+    // Requests stop waiting when their deadline passes
+    index.visit_entry({2, 20}, running(1000));
+    EXPECT_TRUE(wait({2, 20}, now));
+    index.tick();
+    EXPECT_EQ(outcomes, (std::vector<std::string>{"running"}));
+    outcomes.clear();
+
+    // or when the operation expires
+    EXPECT_TRUE(wait({2, 20}, later));
+    index.visit_entry(
+      {2, 30}, succeeded({}, 1000 + OPERATION_EXPIRY.count() + 60));
+    index.tick();
+    EXPECT_EQ(outcomes, (std::vector<std::string>{errors::OperationExpired}));
+    EXPECT_EQ(index.describe()["waiting_requests"], 0);
+  }
+
+  TEST(OperationsIndexTest, LookupBatch)
+  {
+    const time_t later = 1100 + OPERATION_EXPIRY.count();
+    TestIndex index;
+    index.visit_entry({2, 5}, running(1000));
+    index.visit_entry({2, 10}, running(later));
+    index.visit_entry({2, 11}, succeeded(ccf::TxID{2, 10}, {}));
+    index.visit_entry({2, 20}, running(later));
+
+    const auto lookups =
+      index.lookup_batch({{2, 10}, {2, 5}, {2, 15}, {2, 20}, {2, 40}});
+    ASSERT_EQ(lookups.size(), 5);
+
+    // Operations are reported as by /operations/{txid}
+    EXPECT_EQ(lookups[0].operation->status, OperationStatus::Succeeded);
+    EXPECT_EQ(lookups[0].operation->entry_id, (ccf::TxID{2, 11}));
+    EXPECT_FALSE(lookups[0].lookup_error.has_value());
+    EXPECT_EQ(lookups[3].operation->status, OperationStatus::Running);
+
+    // including those which the index hasn't reached yet
+    EXPECT_EQ(lookups[4].operation->status, OperationStatus::Running);
+
+    // Operation IDs which /operations/{txid} rejects are neither running nor
+    // failed.
+    EXPECT_FALSE(lookups[1].operation.has_value());
+    EXPECT_EQ(lookups[1].lookup_error->code, errors::OperationExpired);
+    EXPECT_FALSE(lookups[2].operation.has_value());
+    EXPECT_EQ(lookups[2].lookup_error->code, errors::NotFound);
+    EXPECT_EQ(lookups[2].operation_id, (ccf::TxID{2, 15}));
+  }
+
+  TEST(OperationsIndexTest, LookupBatchTransientError)
+  {
+    TestIndex index;
+    index.visit_entry({2, 10}, running(1000));
+    index.tx_status_result = ccf::ApiResult::InternalError;
+
+    // A failure which has nothing to do with the operations fails the whole
+    // batch, rather than any operation.
+    try
+    {
+      index.lookup_batch({{2, 10}, {2, 11}});
+      FAIL() << "Expected the batch to fail";
+    }
+    catch (const HTTPError& e)
+    {
+      EXPECT_EQ(e.status_code, HTTP_STATUS_SERVICE_UNAVAILABLE);
+      EXPECT_EQ(e.code, errors::InternalError);
+      EXPECT_TRUE(e.headers.contains("Retry-After"));
+    }
+
+    index.tx_status_result = ccf::ApiResult::OK;
+    EXPECT_EQ(
+      index.lookup_batch({{2, 10}}).at(0).operation->status,
+      OperationStatus::Running);
+  }
+
+  TEST(OperationsIndexTest, SkipOldOperationsAtStartup)
+  {
+    constexpr ccf::SeqNo LEDGER_SIZE = 1'000'000;
+    constexpr ccf::SeqNo LOG_INTERVAL = 1000;
+    constexpr time_t CUTOFF = 600'000;
+
+    // An operation log every LOG_INTERVAL transactions, created at the time
+    // of its sequence number.
+    const auto created_at = [](ccf::SeqNo seqno) -> std::optional<time_t> {
+      if (seqno % LOG_INTERVAL == 0)
+      {
+        return seqno;
+      }
+      return std::nullopt;
+    };
+
+    TestIndex index;
+    index.committed_seqno = LEDGER_SIZE;
+    index.now = CUTOFF + OPERATION_EXPIRY.count() + 5 * 60;
+
+    // Like the host, ranges are only available on the second time they are
+    // asked for.
+    std::set<std::pair<ccf::SeqNo, ccf::SeqNo>> requested;
+    size_t fetched = 0;
+    index.find_operation_logs = [&](ccf::SeqNo from, ccf::SeqNo to)
+      -> std::optional<std::vector<ccf::SeqNo>> {
+      if (requested.insert({from, to}).second)
+      {
+        return std::nullopt;
+      }
+      fetched += to - from + 1;
+      std::vector<ccf::SeqNo> seqnos;
+      for (ccf::SeqNo seqno = from; seqno <= to; seqno++)
+      {
+        if (created_at(seqno).has_value())
+        {
+          seqnos.push_back(seqno);
+        }
+      }
+      return seqnos;
+    };
+
+    // The indexer fetches whichever transaction the strategy asks for.
+    size_t probes = 0;
+    while (index.describe()["searching_start"].get<bool>())
+    {
+      const auto seqno = index.next_requested().value();
+      index.visit_search_probe(seqno, created_at(seqno));
+      probes++;
+      ASSERT_LT(probes, 1000);
+    }
+
+    EXPECT_GT(requested.size(), 0);
+    EXPECT_LT(fetched + probes, LEDGER_SIZE / 10);
+
+    const ccf::SeqNo lower_bound = index.describe()["lower_bound"];
+    EXPECT_GT(lower_bound, CUTOFF - LOG_INTERVAL);
+    EXPECT_LE(lower_bound, CUTOFF);
+  }
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "policy_engine.h"
+
+#include "cose.h"
+#include "http_error.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt;
+
+namespace
+{
+  std::optional<std::string> apply(
+    const std::string& script, const cose::ProtectedHeader& phdr)
+  {
+    std::vector<uint8_t> payload = {'{', '}'};
+    return js::apply_js_policy(
+      script, "test", phdr, cose::UnprotectedHeader{}, payload, std::nullopt);
+  }
+
+  cose::ProtectedHeader make_header()
+  {
+    cose::ProtectedHeader phdr;
+    phdr.cwt_claims.iss = "did:example:issuer";
+    // Not a valid certificate, so converting it to PEM fails
+    phdr.x5chain = {{0x00, 0x01, 0x02}};
+    phdr.tss_map.svc_id = "svc";
+    return phdr;
+  }
+
+  TEST(PolicyEngineTest, UnreadPropertiesAreNotConverted)
+  {
+    EXPECT_EQ(
+      apply(
+        R"(export function apply(phdr) {
+          return phdr.cwt.iss === "did:example:issuer" || "Invalid issuer";
+        })",
+        make_header()),
+      std::nullopt);
+
+    EXPECT_THROW(
+      apply(
+        "export function apply(phdr) { return phdr.x5chain.length > 0; }",
+        make_header()),
+      BadRequestCborError);
+  }
+
+  TEST(PolicyEngineTest, LazyProperties)
+  {
+    EXPECT_EQ(
+      apply(
+        R"(export function apply(phdr, uhdr, payload, details) {
+          const keys = Object.keys(phdr);
+          if (!keys.includes("x5chain") || !keys.includes("attestedsvc")) {
+            return "Missing keys: " + keys;
+          }
+          if (phdr.attestedsvc.svc_id !== "svc") {
+            return "Invalid svc_id";
+          }
+          // Converted values are kept
+          if (phdr.attestedsvc !== phdr.attestedsvc) {
+            return "Converted twice";
+          }
+          if ("x5chain" in uhdr || Object.keys(details).length !== 0) {
+            return "Unexpected properties";
+          }
+          return true;
+        })",
+        make_header()),
+      std::nullopt);
+  }
+
+  TEST(PolicyEngineTest, PayloadIsOutsideOfHeap)
+  {
+    // Larger than the heap of the interpreter
+    std::vector<uint8_t> payload(16 * 1024 * 1024, 'x');
+    payload.front() = '{';
+
+    EXPECT_EQ(
+      js::apply_js_policy(
+        R"(export function apply(phdr, uhdr, payload) {
+          const bytes = new Uint8Array(payload);
+          return (bytes.length === 16 * 1024 * 1024 && bytes[0] === 123) ||
+            "Invalid payload";
+        })",
+        "test",
+        make_header(),
+        cose::UnprotectedHeader{},
+        payload,
+        std::nullopt),
+      std::nullopt);
+  }
+
+  TEST(PolicyEngineTest, PayloadIsNotCopied)
+  {
+    std::vector<uint8_t> payload = {'{', '}'};
+
+    EXPECT_EQ(
+      js::apply_js_policy(
+        R"(export function apply(phdr, uhdr, payload) {
+          new Uint8Array(payload).fill(0);
+          return true;
+        })",
+        "test",
+        make_header(),
+        cose::UnprotectedHeader{},
+        payload,
+        std::nullopt),
+      std::nullopt);
+
+    // The script wrote to the caller's memory, which is why the caller must
+    // not use it after the policy.
+    EXPECT_EQ(payload, (std::vector<uint8_t>{0, 0}));
+  }
+}
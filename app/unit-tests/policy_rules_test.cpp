@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "policy_rules.h"
+
+#include "cose.h"
+#include "kv_types.h"
+#include "policy_engine.h"
+#include "verifier.h"
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace scitt;
+
+namespace
+{
+  PolicyRule rule(
+    const std::string& field, const std::string& op, nlohmann::json value)
+  {
+    return PolicyRule{
+      .field = field, .op = op, .value = std::move(value), .reason = {}};
+  }
+
+  cose::ProtectedHeader make_header()
+  {
+    cose::ProtectedHeader phdr;
+    phdr.alg = -7;
+    phdr.cty = "application/json";
+    phdr.cwt_claims.iss = "did:x509:0:sha256:abc::eku:1.2.3";
+    phdr.cwt_claims.svn = 3;
+    return phdr;
+  }
+
+  TEST(PolicyRulesTest, Compile)
+  {
+    EXPECT_NO_THROW(CompiledPolicyRules::compile({}));
+    EXPECT_NO_THROW(CompiledPolicyRules::compile({
+      rule("phdr.cwt.iss", "startsWith", "did:x509:"),
+      rule("phdr.cwt.svn", ">=", 1),
+      rule("phdr.cty", "==", 50),
+      rule("phdr.cty", "==", "application/json"),
+      rule("details.product_name", "in", {"Milan", "Genoa"}),
+    }));
+
+    EXPECT_THROW(
+      CompiledPolicyRules::compile({rule("phdr.unknown", "==", 1)}),
+      std::invalid_argument);
+    EXPECT_THROW(
+      CompiledPolicyRules::compile({rule("phdr.cwt.svn", "=~", 1)}),
+      std::invalid_argument);
+    EXPECT_THROW(
+      CompiledPolicyRules::compile({rule("phdr.cwt.svn", ">=", "1")}),
+      std::invalid_argument);
+    EXPECT_THROW(
+      CompiledPolicyRules::compile({rule("phdr.cwt.iss", "==", 1)}),
+      std::invalid_argument);
+    EXPECT_THROW(
+      CompiledPolicyRules::compile({rule("phdr.cwt.svn", "startsWith", "1")}),
+      std::invalid_argument);
+    EXPECT_THROW(
+      CompiledPolicyRules::compile({rule("phdr.cwt.iss", "in", "did:")}),
+      std::invalid_argument);
+    EXPECT_THROW(
+      CompiledPolicyRules::compile({rule("phdr.cwt.iss", "in", {1, 2})}),
+      std::invalid_argument);
+  }
+
+  TEST(PolicyRulesTest, Evaluate)
+  {
+    const auto phdr = make_header();
+    const auto evaluate = [&](const PolicyRule& r) {
+      return CompiledPolicyRules::compile({r}).evaluate(phdr, std::nullopt);
+    };
+
+    EXPECT_EQ(evaluate(rule("phdr.alg", "==", -7)), std::nullopt);
+    EXPECT_NE(evaluate(rule("phdr.alg", "!=", -7)), std::nullopt);
+    EXPECT_EQ(evaluate(rule("phdr.cwt.svn", ">=", 3)), std::nullopt);
+    EXPECT_NE(evaluate(rule("phdr.cwt.svn", ">", 3)), std::nullopt);
+    EXPECT_EQ(evaluate(rule("phdr.cwt.svn", "<", 4)), std::nullopt);
+    EXPECT_NE(evaluate(rule("phdr.cwt.svn", "<=", 2)), std::nullopt);
+    EXPECT_EQ(evaluate(rule("phdr.cwt.svn", "in", {1, 3})), std::nullopt);
+    EXPECT_NE(evaluate(rule("phdr.cwt.svn", "in", {1, 2})), std::nullopt);
+    EXPECT_EQ(
+      evaluate(rule("phdr.cwt.iss", "startsWith", "did:x509:")), std::nullopt);
+    EXPECT_NE(
+      evaluate(rule("phdr.cwt.iss", "startsWith", "did:attestedsvc:")),
+      std::nullopt);
+
+    // Fields which may have either type only match values of the same type
+    EXPECT_EQ(
+      evaluate(rule("phdr.cty", "==", "application/json")), std::nullopt);
+    EXPECT_NE(evaluate(rule("phdr.cty", "==", 50)), std::nullopt);
+    EXPECT_EQ(evaluate(rule("phdr.cty", "!=", 50)), std::nullopt);
+
+    // Rules on absent fields are never met
+    EXPECT_NE(evaluate(rule("phdr.cwt.sub", "!=", "x")), std::nullopt);
+    EXPECT_NE(evaluate(rule("details.host_data", "!=", "x")), std::nullopt);
+  }
+
+  TEST(PolicyRulesTest, Reason)
+  {
+    const auto phdr = make_header();
+
+    auto rules = CompiledPolicyRules::compile({
+      rule("phdr.cwt.iss", "startsWith", "did:x509:"),
+      rule("phdr.cwt.svn", ">=", 5),
+      rule("phdr.alg", "==", -35),
+    });
+    EXPECT_EQ(
+      rules.evaluate(phdr, std::nullopt), "Rule not met: phdr.cwt.svn >= 5");
+
+    auto with_reason = rule("phdr.cwt.svn", ">=", 5);
+    with_reason.reason = "Invalid SVN";
+    EXPECT_EQ(
+      CompiledPolicyRules::compile({with_reason}).evaluate(phdr, std::nullopt),
+      "Invalid SVN");
+  }
+
+  TEST(PolicyRulesTest, Json)
+  {
+    auto policy = nlohmann::json::parse(R"({
+      "policyRules": [
+        {"field": "phdr.cwt.svn", "op": ">=", "value": 1},
+        {"field": "phdr.cwt.iss", "op": "in", "value": ["a", "b"],
+         "reason": "Invalid issuer"}
+      ]
+    })")
+                    .get<Configuration::Policy>();
+
+    ASSERT_TRUE(policy.policy_rules.has_value());
+    ASSERT_EQ(policy.policy_rules->size(), 2);
+    EXPECT_EQ(policy.policy_rules->at(0), rule("phdr.cwt.svn", ">=", 1));
+    EXPECT_EQ(policy.policy_rules->at(1).reason, "Invalid issuer");
+  }
+
+  // Check the rules against an equivalent policy script, on an attested signed
+  // statement which exercises both header and attestation fields.
+  TEST(PolicyRulesTest, MatchesScript)
+  {
+    std::string filepath = "test_payloads/css-attested-cosesign1-20250925.cose";
+    std::ifstream file(filepath, std::ios::binary);
+    ASSERT_TRUE(file.is_open());
+    std::vector<uint8_t> signed_statement(std::filesystem::file_size(filepath));
+    file.read(
+      reinterpret_cast<char*>(signed_statement.data()),
+      static_cast<std::streamsize>(signed_statement.size()));
+
+    auto verifier = std::make_unique<verifier::Verifier>();
+    ccf::kv::ReadOnlyTx* tx_ptr = nullptr;
+    timespec time = {0, 0};
+    Configuration configuration;
+    cose::ProtectedHeader phdr;
+    cose::UnprotectedHeader uhdr;
+    std::span<uint8_t> payload;
+    std::optional<verifier::VerifiedSevSnpAttestationDetails> details;
+    std::tie(phdr, uhdr, payload, details) = verifier->verify_signed_statement(
+      signed_statement, *tx_ptr, time, configuration);
+
+    const auto script = [](const std::string& product_name) {
+      return fmt::format(
+        R"(
+        export function apply(phdr, uhdr, payload, details) {{
+          if (details.product_name !== "{}") {{ return "Invalid product"; }}
+          if (details.uvm_endorsements.svn < "101") {{
+            return "Invalid uvm_endorsements svn";
+          }}
+          if (!phdr.cwt.iss.startsWith("did:attestedsvc:msft-css-dev:")) {{
+            return "Invalid issuer";
+          }}
+          return true;
+        }})",
+        product_name);
+    };
+    const auto rules = [](const std::string& product_name) {
+      auto product_rule = rule("details.product_name", "==", product_name);
+      product_rule.reason = "Invalid product";
+      return CompiledPolicyRules::compile({
+        product_rule,
+        rule("details.uvm_endorsements.svn", ">=", "101"),
+        rule("phdr.cwt.iss", "startsWith", "did:attestedsvc:msft-css-dev:"),
+      });
+    };
+
+    for (const std::string product_name : {"Milan", "Genoa"})
+    {
+      EXPECT_EQ(
+        rules(product_name).evaluate(phdr, details),
+        js::apply_js_policy(
+          script(product_name), "test", phdr, uhdr, payload, details))
+        << product_name;
+    }
+    EXPECT_EQ(rules("Milan").evaluate(phdr, details), std::nullopt);
+  }
+}
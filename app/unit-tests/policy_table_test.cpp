@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "policy_table.h"
+
+#include "kv_types.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt;
+
+namespace
+{
+  Configuration::Policy::Route route(
+    const std::string& issuer_prefix, const PolicyScript& script)
+  {
+    return Configuration::Policy::Route{
+      .issuer_prefix = issuer_prefix,
+      .policy_script = script,
+      .policy_rules = {}};
+  }
+
+  TEST(PolicyTableTest, Select)
+  {
+    Configuration::Policy policy;
+    policy.policy_script = "fallback";
+    policy.policy_routes = {
+      route("did:x509:", "x509"),
+      route("did:x509:0:sha256:abc::", "x509-abc"),
+      route("did:attestedsvc:", "attestedsvc"),
+    };
+    const auto table = PolicyTable::compile(policy);
+
+    const auto script = [&](const std::optional<std::string>& issuer) {
+      return table.select(issuer).script;
+    };
+
+    // The longest matching prefix wins, whatever the order of the routes
+    EXPECT_EQ(script("did:x509:0:sha256:abc::eku:1.2.3"), "x509-abc");
+    EXPECT_EQ(script("did:x509:0:sha256:def::eku:1.2.3"), "x509");
+    EXPECT_EQ(script("did:attestedsvc:msft-css-dev:svc"), "attestedsvc");
+    EXPECT_EQ(
+      table.select("did:x509:0:sha256:abc::").name,
+      "configured_policy[did:x509:0:sha256:abc::]");
+
+    // Otherwise, the policy set outside of any route is used
+    EXPECT_EQ(script("did:web:example.com"), "fallback");
+    EXPECT_EQ(script(std::nullopt), "fallback");
+    EXPECT_EQ(table.select(std::nullopt).name, "configured_policy");
+  }
+
+  TEST(PolicyTableTest, Empty)
+  {
+    Configuration::Policy policy;
+    EXPECT_TRUE(PolicyTable::compile(policy).select("did:x509:").empty());
+
+    policy.policy_routes = {Configuration::Policy::Route{
+      .issuer_prefix = "did:x509:",
+      .policy_script = {},
+      .policy_rules = std::vector<PolicyRule>{}}};
+    const auto table = PolicyTable::compile(policy);
+    EXPECT_FALSE(table.select("did:x509:0").empty());
+    EXPECT_TRUE(table.select("did:web:example.com").empty());
+  }
+
+  TEST(PolicyTableTest, InvalidRoute)
+  {
+    Configuration::Policy policy;
+    policy.policy_routes = {Configuration::Policy::Route{
+      .issuer_prefix = "did:x509:",
+      .policy_script = {},
+      .policy_rules = std::vector<PolicyRule>{PolicyRule{
+        .field = "phdr.unknown", .op = "==", .value = 1, .reason = {}}}}};
+
+    try
+    {
+      PolicyTable::compile(policy);
+      FAIL() << "Expected std::invalid_argument";
+    }
+    catch (const std::invalid_argument& e)
+    {
+      EXPECT_TRUE(std::string(e.what()).starts_with(
+        "Route for issuer prefix did:x509:: Rule 0 (phdr.unknown)"))
+        << e.what();
+    }
+  }
+}
@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "policy_verdict_cache.h"
+
+#include "cose.h"
+#include "policy_engine.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt;
+
+namespace
+{
+  const std::string SCRIPT = "export function apply() { return true; }";
+  const std::vector<uint8_t> ENCODED_A = {0xa1, 0x01, 0x26};
+  const std::vector<uint8_t> ENCODED_B = {0xa1, 0x01, 0x38, 0x22};
+
+  cose::ProtectedHeader make_header(const std::vector<uint8_t>& encoded)
+  {
+    cose::ProtectedHeader phdr;
+    phdr.encoded = encoded;
+    return phdr;
+  }
+
+  TEST(PolicyVerdictCacheTest, Key)
+  {
+    const cose::UnprotectedHeader uhdr;
+    const auto key = [&](const std::string& script, const auto& phdr) {
+      return PolicyVerdictCache::make_key(script, phdr, uhdr, std::nullopt);
+    };
+
+    EXPECT_EQ(
+      key(SCRIPT, make_header(ENCODED_A)), key(SCRIPT, make_header(ENCODED_A)));
+    EXPECT_NE(
+      key(SCRIPT, make_header(ENCODED_A)), key(SCRIPT, make_header(ENCODED_B)));
+    EXPECT_NE(
+      key(SCRIPT, make_header(ENCODED_A)),
+      key(SCRIPT + " ", make_header(ENCODED_A)));
+
+    cose::UnprotectedHeader with_x5chain;
+    with_x5chain.x5chain = {{0x01}};
+    EXPECT_NE(
+      PolicyVerdictCache::make_key(
+        SCRIPT, make_header(ENCODED_A), with_x5chain, std::nullopt),
+      key(SCRIPT, make_header(ENCODED_A)));
+
+    // Headers which were not decoded cannot be told apart
+    EXPECT_EQ(key(SCRIPT, cose::ProtectedHeader{}), std::nullopt);
+  }
+
+  TEST(PolicyVerdictCacheTest, Configure)
+  {
+    PolicyVerdictCache cache;
+    const PolicyVerdictCache::Verdict refused = "Refused";
+    const auto key = PolicyVerdictCache::make_key(
+                       SCRIPT,
+                       make_header(ENCODED_A),
+                       cose::UnprotectedHeader{},
+                       std::nullopt)
+                       .value();
+
+    // Nothing is cached until the cache is configured with a size
+    cache.insert(key, refused);
+    EXPECT_EQ(cache.find(key), std::nullopt);
+
+    cache.configure(1, 10);
+    cache.insert(key, refused);
+    EXPECT_EQ(cache.find(key), std::make_optional(refused));
+
+    cache.configure(1, 10);
+    EXPECT_EQ(cache.find(key), std::make_optional(refused));
+
+    // A new configuration clears the cache
+    cache.configure(2, 10);
+    EXPECT_EQ(cache.find(key), std::nullopt);
+  }
+
+  TEST(PolicyVerdictCacheTest, CachedVerdictIsReused)
+  {
+    PolicyVerdictCache cache;
+    cache.configure(1, 10);
+
+    const auto phdr = make_header(ENCODED_A);
+    const cose::UnprotectedHeader uhdr;
+    std::vector<uint8_t> payload;
+
+    EXPECT_EQ(
+      check_for_policy_violations(
+        SCRIPT, "test", phdr, uhdr, payload, std::nullopt, &cache),
+      std::nullopt);
+
+    // Overwrite the verdict, to check that the script is not run again
+    const auto key =
+      PolicyVerdictCache::make_key(SCRIPT, phdr, uhdr, std::nullopt).value();
+    cache.configure(2, 10);
+    cache.insert(key, "Cached");
+    EXPECT_EQ(
+      check_for_policy_violations(
+        SCRIPT, "test", phdr, uhdr, payload, std::nullopt, &cache),
+      "Cached");
+
+    // Errors are not cached
+    const std::string throwing = "export function apply() { throw 'Boom'; }";
+    EXPECT_THROW(
+      check_for_policy_violations(
+        throwing, "test", phdr, uhdr, payload, std::nullopt, &cache),
+      BadRequestCborError);
+    EXPECT_EQ(
+      cache.find(
+        PolicyVerdictCache::make_key(throwing, phdr, uhdr, std::nullopt)
+          .value()),
+      std::nullopt);
+  }
+
+  TEST(PolicyVerdictCacheTest, PayloadIsSkipped)
+  {
+    PolicyVerdictCache cache;
+    cache.configure(1, 10);
+
+    const std::string script = R"(export function apply(phdr, uhdr, payload) {
+      return payload.byteLength === 0 || "Payload was passed";
+    })";
+    const auto phdr = make_header(ENCODED_A);
+    const cose::UnprotectedHeader uhdr;
+    std::vector<uint8_t> payload = {'{', '}'};
+
+    // Policies whose verdicts are cached don't depend on the payload, and
+    // are not given it.
+    EXPECT_EQ(
+      check_for_policy_violations(
+        script, "test", phdr, uhdr, payload, std::nullopt, &cache),
+      std::nullopt);
+    EXPECT_EQ(
+      check_for_policy_violations(
+        script, "test", phdr, uhdr, payload, std::nullopt),
+      "Payload was passed");
+  }
+}
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "rate_limiter.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt;
+using namespace std::chrono_literals;
+
+namespace
+{
+  TEST(TokenBucketsTest, Burst)
+  {
+    TokenBuckets buckets;
+    RateLimit limit{.rate_per_second = 1, .burst = 3};
+    auto now = TokenBuckets::Clock::now();
+
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now).has_value());
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now).has_value());
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now).has_value());
+
+    auto wait = buckets.try_acquire("a", limit, now);
+    ASSERT_TRUE(wait.has_value());
+    EXPECT_DOUBLE_EQ(wait->count(), 1);
+
+    // Other keys have their own bucket.
+    EXPECT_FALSE(buckets.try_acquire("b", limit, now).has_value());
+  }
+
+  TEST(TokenBucketsTest, Refill)
+  {
+    TokenBuckets buckets;
+    RateLimit limit{.rate_per_second = 2, .burst = 1};
+    auto now = TokenBuckets::Clock::now();
+
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now).has_value());
+
+    auto wait = buckets.try_acquire("a", limit, now + 250ms);
+    ASSERT_TRUE(wait.has_value());
+    EXPECT_DOUBLE_EQ(wait->count(), 0.25);
+
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now + 500ms).has_value());
+
+    // Tokens do not accumulate beyond the burst size.
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now + 10s).has_value());
+    EXPECT_TRUE(buckets.try_acquire("a", limit, now + 10s).has_value());
+  }
+
+  TEST(TokenBucketsTest, LimitChanges)
+  {
+    TokenBuckets buckets;
+    auto now = TokenBuckets::Clock::now();
+
+    RateLimit large{.rate_per_second = 1, .burst = 10};
+    EXPECT_FALSE(buckets.try_acquire("a", large, now).has_value());
+
+    // A smaller burst applies to existing buckets straight away.
+    RateLimit small{.rate_per_second = 1, .burst = 1};
+    EXPECT_FALSE(buckets.try_acquire("a", small, now).has_value());
+    EXPECT_TRUE(buckets.try_acquire("a", small, now).has_value());
+  }
+
+  TEST(TokenBucketsTest, ZeroRate)
+  {
+    TokenBuckets buckets;
+    RateLimit limit{.rate_per_second = 0, .burst = 1};
+    auto now = TokenBuckets::Clock::now();
+
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now).has_value());
+    auto wait = buckets.try_acquire("a", limit, now + 1h);
+    ASSERT_TRUE(wait.has_value());
+    EXPECT_EQ(retry_after_seconds(*wait), 3600);
+  }
+
+  TEST(TokenBucketsTest, Eviction)
+  {
+    TokenBuckets buckets(1);
+    RateLimit limit{.rate_per_second = 1, .burst = 1};
+    auto now = TokenBuckets::Clock::now();
+
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now).has_value());
+    EXPECT_FALSE(buckets.try_acquire("b", limit, now).has_value());
+
+    // The bucket of "a" was evicted, and starts full again.
+    EXPECT_FALSE(buckets.try_acquire("a", limit, now).has_value());
+  }
+
+  TEST(TokenBucketsTest, RetryAfterSeconds)
+  {
+    EXPECT_EQ(retry_after_seconds(std::chrono::duration<double>(0)), 1);
+    EXPECT_EQ(retry_after_seconds(std::chrono::duration<double>(0.25)), 1);
+    EXPECT_EQ(retry_after_seconds(std::chrono::duration<double>(1.5)), 2);
+  }
+}
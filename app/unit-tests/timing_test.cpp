@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "timing.h"
+
+#include <gtest/gtest.h>
+
+using namespace scitt::timing;
+using namespace std::chrono_literals;
+
+namespace
+{
+  TEST(TimingTest, StageTimings)
+  {
+    StageTimings timings;
+    EXPECT_TRUE(timings.empty());
+    EXPECT_EQ(timings.to_string(), "");
+
+    timings.add(Stage::Signature, 300us);
+    timings.add(Stage::Decode, 12us);
+    timings.add(Stage::Signature, 40us);
+    EXPECT_FALSE(timings.empty());
+    EXPECT_EQ(timings.to_string(), "DecodeUs=12 SignatureUs=340");
+  }
+
+  TEST(TimingTest, ScopedStageTimer)
+  {
+    stage_timings = {};
+    {
+      ScopedStageTimer timer(Stage::Policy);
+    }
+    EXPECT_TRUE(stage_timings.recorded[static_cast<size_t>(Stage::Policy)]);
+    EXPECT_FALSE(stage_timings.recorded[static_cast<size_t>(Stage::Kv)]);
+    stage_timings = {};
+  }
+
+  TEST(TimingTest, RecordStageTimings)
+  {
+    auto& histogram = stage_histogram(Stage::Snp);
+    auto count = histogram.get_count();
+
+    StageTimings timings;
+    timings.add(Stage::Snp, 5ms);
+    record_stage_timings(timings);
+    EXPECT_EQ(histogram.get_count(), count + 1);
+    EXPECT_EQ(stage_histogram(Stage::Kv).get_count(), 0);
+  }
+}
@@ -30,6 +30,10 @@ CT_APPLICATION_CBOR_ERROR = "application/concise-problem-details+cbor"
 CBOR_ERR_TITLE_TAG = -1
 CBOR_ERR_DETAIL_TAG = -2
 
+# How long to ask the service to wait for an operation to complete, in each
+# request to /operations/{txid}.
+OPERATION_WAIT_SECONDS = 10
+
 
 class MemberAuthenticationMethod(ABC):
     cert: str
@@ -585,8 +589,12 @@ class Client(BaseClient):
         return Submission(operation_id, tx, receipt, False)
 
     def wait_for_operation(self, operation: str) -> str:
+        # The service holds on to the request until the operation completes,
+        # or until the wait is over, in which case we ask again.
         resp = self.get(
             f"/operations/{operation}",
+            params={"wait": OPERATION_WAIT_SECONDS},
+            timeout=OPERATION_WAIT_SECONDS + 5,
             retry_on=[
                 HTTPStatus.ACCEPTED.value,
                 HTTPStatus.TOO_MANY_REQUESTS.value,
@@ -606,6 +614,22 @@ class Client(BaseClient):
         else:
             raise ValueError("Invalid status {}".format(response["Status"]))
 
+    def get_operations(self, operations: Iterable[str]) -> list:
+        """
+        Get the state of many operations in a single request.
+
+        The result has one entry per operation ID, in the same order, each in
+        the same format as the response of `/operations/{txid}`. Operation IDs
+        which that endpoint would reject, for instance because the operation
+        has expired, have a "LookupError" instead of a "Status".
+        """
+        resp = self.post(
+            "/operations/status",
+            headers={"Content-Type": "application/cbor"},
+            content=cbor2.dumps(list(operations)),
+        )
+        return cbor2.loads(resp.read())
+
     def get_claim(self, tx: str) -> bytes:
         response = self.get_historical(f"/entries/{tx}")
         return response.content
@@ -667,6 +691,28 @@ class Client(BaseClient):
 
             link = body.get("nextLink")
 
+    def count_statements(
+        self, *, start: Optional[int] = None, end: Optional[int] = None
+    ) -> int:
+        """
+        Count the statements on the ledger, with an optional start and end range.
+
+        This is answered by the service's index directly, and does not require
+        enumerating every statement in the range.
+        """
+        params = {}
+        if start is not None:
+            params["from"] = start
+        if end is not None:
+            params["to"] = end
+
+        response = self.get(
+            "/entries/count",
+            params=params,
+            retry_on=[(HTTPStatus.SERVICE_UNAVAILABLE, "IndexingInProgressRetryLater")],
+        )
+        return response.json()["count"]
+
     def wait_for_network_open(self):
         self.get(
             "/node/network",
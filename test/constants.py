@@ -5,3 +5,7 @@
 # Make sure to keep them in sync.
 
 OPERATION_EXPIRY_SECONDS = 60 * 60
+
+MAX_OPERATIONS_PER_BATCH = 1000
+
+MAX_OPERATION_WAIT_SECONDS = 30
@@ -18,6 +18,7 @@ from pyscitt.verify import (
     verify_transparent_statement,
 )
 
+from .constants import MAX_OPERATION_WAIT_SECONDS
 from .infra.assertions import service_error
 
 
@@ -153,6 +154,20 @@ def test_recovery(client, cert_authority, restart_service, configure_service):
     )
 
 
+@pytest.mark.parametrize("path", ["/parameters", "/parameters/historic"])
+def test_parameters_accept(client: Client, path: str):
+    """
+    Test that service parameters, which are served from a cached JSON
+    response, honour the Accept header.
+    """
+    response = client.get(path, headers={"Accept": "application/json"})
+    assert response.status_code == 200
+    assert response.headers["Content-Type"] == "application/json"
+
+    with service_error("UnsupportedContentType"):
+        client.get(path, headers={"Accept": "application/cbor"})
+
+
 @pytest.mark.isolated_test
 def test_transparency_configuration(client, cchost):
     issuer = f"127.0.0.1:{cchost.rpc_port}"
@@ -161,3 +176,79 @@ def test_transparency_configuration(client, cchost):
     assert config.status_code == 200
     assert config.headers["Content-Type"] == "application/cbor"
     assert cbor2.loads(config.content) == reference
+
+
+def test_metrics(client: Client):
+    """
+    Test that the metrics endpoint exposes request counters in the Prometheus
+    text format.
+    """
+
+    client.get("/version")
+
+    metrics = client.get("/metrics")
+    assert metrics.status_code == 200
+    assert metrics.headers["Content-Type"].startswith("text/plain")
+    assert "# TYPE scitt_requests_total counter" in metrics.text
+    assert 'scitt_requests_total{endpoint="/version"}' in metrics.text
+    assert "# TYPE scitt_request_duration_seconds histogram" in metrics.text
+
+
+def test_issuer_costs(client: Client, cert_authority, configure_service):
+    """
+    Test that the time spent verifying signed statements is attributed to
+    their issuer.
+    """
+    configure_service(
+        {"policy": {"policyScript": "export function apply() { return true; }"}}
+    )
+
+    identity = cert_authority.create_identity(alg="ES256", kty="ec", add_eku="2.999")
+    signed_statement = crypto.sign_json_statement(identity, {"foo": "bar"}, cwt=True)
+    client.submit_signed_statement_and_wait(signed_statement)
+
+    with service_error("InvalidAuthenticationInfo"):
+        client.get("/diagnostics/issuers")
+
+    costs = client.get(
+        "/diagnostics/issuers", params={"top": 100}, sign_request=True
+    ).json()
+    assert costs["minutes"] == 5
+    issuers = {cost["issuer"]: cost for cost in costs["issuers"]}
+    assert identity.issuer in issuers
+    assert issuers[identity.issuer]["count"] >= 1
+    assert issuers[identity.issuer]["bytes"] >= len(signed_statement)
+
+    with service_error("QueryParameterError"):
+        client.get(
+            "/diagnostics/issuers", params={"minutes": 0}, sign_request=True
+        )
+
+
+def test_wait_for_operation(client: Client, cert_authority, configure_service):
+    """
+    Test that a client can wait for an operation to complete, rather than poll
+    for it.
+    """
+    configure_service(
+        {"policy": {"policyScript": "export function apply() { return true; }"}}
+    )
+
+    identity = cert_authority.create_identity(alg="ES256", kty="ec", add_eku="2.999")
+    signed_statement = crypto.sign_json_statement(identity, {"foo": "bar"}, cwt=True)
+    submission = client.submit_signed_statement(signed_statement)
+
+    # A single request is answered once the operation completes
+    response = client.get(
+        f"/operations/{submission.operation_tx}",
+        params={"wait": MAX_OPERATION_WAIT_SECONDS},
+        timeout=MAX_OPERATION_WAIT_SECONDS + 5,
+    )
+    assert response.status_code == 200
+    assert cbor2.loads(response.read())["Status"] == "succeeded"
+
+    with service_error("QueryParameterError"):
+        client.get(
+            f"/operations/{submission.operation_tx}",
+            params={"wait": MAX_OPERATION_WAIT_SECONDS + 1},
+        )
@@ -89,6 +89,179 @@ class TestAcceptedAlgorithms:
         submit(alg="PS256", kty="rsa")
 
 
+class TestHeaderLimits:
+    @pytest.fixture
+    def submit(self, client: Client, cert_authority):
+        def f(**kwargs):
+            """Sign and submit the statement with a new identity"""
+            identity = cert_authority.create_identity(
+                alg="ES256", kty="ec", add_eku="2.999", **kwargs
+            )
+            signed_statement = crypto.sign_json_statement(
+                identity, {"foo": "bar"}, cwt=True
+            )
+            client.submit_signed_statement_and_wait(signed_statement)
+
+        return f
+
+    def test_accepted_issuer_prefixes(self, configure_service, submit):
+        policy = {"policyScript": "export function apply() { return true; }"}
+
+        configure_service(
+            {"policy": {**policy, "acceptedIssuerPrefixes": ["did:example:"]}}
+        )
+        with service_error("InvalidInput: Unsupported issuer"):
+            submit()
+
+        configure_service(
+            {
+                "policy": {
+                    **policy,
+                    "acceptedIssuerPrefixes": ["did:example:", "did:x509:0:"],
+                }
+            }
+        )
+        submit()
+
+    def test_max_x5chain_length(self, configure_service, submit):
+        configure_service(
+            {
+                "policy": {
+                    "policyScript": "export function apply() { return true; }",
+                    "maxX5chainLength": 2,
+                }
+            }
+        )
+        with service_error("InvalidInput: x5chain length"):
+            submit(length=3)
+
+    def test_max_protected_header_size(self, configure_service, submit):
+        configure_service(
+            {
+                "policy": {
+                    "policyScript": "export function apply() { return true; }",
+                    "maxProtectedHeaderBytes": 16,
+                }
+            }
+        )
+        with service_error("InvalidInput: Protected header size"):
+            submit()
+
+
+class TestLogging:
+    def test_sampled_compact_logging(
+        self, client: Client, configure_service, cert_authority
+    ):
+        # Logging settings only affect what the service logs, never how it
+        # responds, even when a request is not sampled.
+        configure_service(
+            {
+                "policy": {"policyScript": "export function apply() { return true; }"},
+                "logging": {
+                    "sampling": {"/entries": 0, "/entries/{txid}": 0.5},
+                    "compact": True,
+                },
+            }
+        )
+
+        identity = cert_authority.create_identity(
+            alg="ES256", kty="ec", add_eku="2.999"
+        )
+        signed_statement = crypto.sign_json_statement(
+            identity, {"foo": "bar"}, cwt=True
+        )
+        tx = client.submit_signed_statement_and_wait(signed_statement).tx
+        for _ in range(4):
+            client.get_transparent_statement(tx)
+
+    def test_slow_requests(self, client: Client, configure_service, cert_authority):
+        # With a threshold of zero, every request is recorded.
+        configure_service(
+            {
+                "policy": {"policyScript": "export function apply() { return true; }"},
+                "logging": {"slowRequestThresholdMs": 0},
+            }
+        )
+
+        identity = cert_authority.create_identity(
+            alg="ES256", kty="ec", add_eku="2.999"
+        )
+        signed_statement = crypto.sign_json_statement(
+            identity, {"foo": "bar"}, cwt=True
+        )
+        client.submit_signed_statement_and_wait(signed_statement)
+
+        # Only members of the service may look at other users' requests
+        with service_error("InvalidAuthenticationInfo"):
+            client.get("/diagnostics/slowRequests")
+
+        slow_requests = client.get(
+            "/diagnostics/slowRequests", sign_request=True
+        ).json()
+        assert slow_requests["total"] >= len(slow_requests["requests"]) > 0
+
+        registrations = [
+            r for r in slow_requests["requests"] if r["path"] == "/entries"
+        ]
+        assert registrations
+        assert registrations[0]["bodySize"] == len(signed_statement)
+        assert registrations[0]["issuerType"] == "did:x509"
+        assert "Signature" in registrations[0]["stagesUs"]
+
+
+class TestRateLimits:
+    def test_per_issuer_rate_limit(
+        self, client: Client, configure_service, cert_authority
+    ):
+        configure_service(
+            {
+                "policy": {"policyScript": "export function apply() { return true; }"},
+                "rateLimits": {"perIssuer": {"ratePerSecond": 0.01, "burst": 1}},
+            }
+        )
+
+        identity = cert_authority.create_identity(
+            alg="ES256", kty="ec", add_eku="2.999"
+        )
+        client.submit_signed_statement_and_wait(
+            crypto.sign_json_statement(identity, {"foo": "bar"}, cwt=True)
+        )
+
+        with service_error("TooManyRequests") as excinfo:
+            client.submit_signed_statement_and_wait(
+                crypto.sign_json_statement(identity, {"foo": "baz"}, cwt=True)
+            )
+        assert 1 <= int(excinfo.value.headers["retry-after"]) <= 100
+        assert identity.issuer not in str(excinfo.value)
+
+        # Other issuers have their own limit.
+        other_identity = cert_authority.create_identity(
+            alg="ES256", kty="ec", add_eku="2.999.1"
+        )
+        client.submit_signed_statement_and_wait(
+            crypto.sign_json_statement(other_identity, {"foo": "bar"}, cwt=True)
+        )
+
+        # Statements which fail verification don't count against the limit of
+        # the issuer they claim.
+        third_identity = cert_authority.create_identity(
+            alg="ES256", kty="ec", add_eku="2.999.2"
+        )
+        statement = crypto.sign_json_statement(third_identity, {"foo": "bar"}, cwt=True)
+        forged_statement = statement[:-1] + bytes([statement[-1] ^ 1])
+        with service_error("InvalidInput"):
+            client.submit_signed_statement_and_wait(forged_statement)
+        client.submit_signed_statement_and_wait(statement)
+
+        # Lifting the limit applies straight away.
+        configure_service(
+            {"policy": {"policyScript": "export function apply() { return true; }"}}
+        )
+        client.submit_signed_statement_and_wait(
+            crypto.sign_json_statement(identity, {"foo": "baz"}, cwt=True)
+        )
+
+
 class TestPolicyEngine:
     @pytest.fixture(scope="class")
     def signed_statement(self, cert_authority: X5ChainCertificateAuthority):
@@ -601,3 +774,167 @@ return true;
         configure_service({"policy": {"policyScript": policy_script}})
 
         client.submit_signed_statement_and_wait(signed_statement_with_attestation)
+
+    def test_policy_rules(self, client: Client, configure_service, signed_statement):
+        statement = signed_statement()
+        configure_service(
+            {
+                "policy": {
+                    "policyRules": [
+                        {"field": "phdr.cwt.iss", "op": "startsWith", "value": "did:"},
+                        {"field": "phdr.alg", "op": "==", "value": -7},
+                    ]
+                }
+            }
+        )
+        client.submit_signed_statement_and_wait(statement)
+
+        configure_service(
+            {
+                "policy": {
+                    "policyRules": [
+                        {
+                            "field": "phdr.cwt.iss",
+                            "op": "startsWith",
+                            "value": "did:attestedsvc:",
+                            "reason": "Invalid issuer",
+                        },
+                    ]
+                }
+            }
+        )
+        with service_error("PolicyFailed: Policy was not met: Invalid issuer"):
+            client.submit_signed_statement_and_wait(statement)
+
+        # Rules are checked before the script, which only runs if they are met
+        configure_service(
+            {
+                "policy": {
+                    "policyRules": [{"field": "phdr.alg", "op": "==", "value": -7}],
+                    "policyScript": "export function apply() { return 'Refused'; }",
+                }
+            }
+        )
+        with service_error("Policy was not met: Refused"):
+            client.submit_signed_statement_and_wait(statement)
+
+    def test_invalid_policy_rules(
+        self, client: Client, configure_service, signed_statement
+    ):
+        configure_service(
+            {"policy": {"policyRules": [{"field": "phdr.foo", "op": "==", "value": 1}]}}
+        )
+        with service_error("PolicyError: Invalid policy rules"):
+            client.submit_signed_statement_and_wait(signed_statement())
+
+    def test_attestedsvc_policy_rules(
+        self, client: Client, configure_service, signed_statement_with_attestation
+    ):
+        host_data = "73973b78d70cc68353426de188db5dfc57e5b766e399935fb73a61127ea26d20"
+        configure_service(
+            {
+                "policy": {
+                    "policyRules": [
+                        {"field": "details.product_name", "op": "==", "value": "Milan"},
+                        {"field": "details.host_data", "op": "==", "value": host_data},
+                        {
+                            "field": "details.uvm_endorsements.svn",
+                            "op": ">=",
+                            "value": "101",
+                        },
+                    ]
+                }
+            }
+        )
+        client.submit_signed_statement_and_wait(signed_statement_with_attestation)
+
+    def test_policy_verdict_cache(
+        self, client: Client, configure_service, signed_statement
+    ):
+        def cache_hits() -> int:
+            for line in client.get("/metrics").text.splitlines():
+                if line.startswith("scitt_policy_cache_hits_total "):
+                    return int(float(line.split()[1]))
+            return 0
+
+        statement = signed_statement()
+        configure_service(
+            {
+                "policy": {
+                    "policyScript": "export function apply() { return 'Refused'; }",
+                    "policyVerdictCacheSize": 10,
+                }
+            }
+        )
+        with service_error("Policy was not met: Refused"):
+            client.submit_signed_statement_and_wait(statement)
+        hits = cache_hits()
+        with service_error("Policy was not met: Refused"):
+            client.submit_signed_statement_and_wait(statement)
+        assert cache_hits() == hits + 1
+
+        # The cache is cleared when the configuration changes
+        configure_service(
+            {
+                "policy": {
+                    "policyScript": "export function apply() { return true; }",
+                    "policyVerdictCacheSize": 10,
+                }
+            }
+        )
+        client.submit_signed_statement_and_wait(statement)
+
+    def test_policy_routes(
+        self,
+        client: Client,
+        configure_service,
+        signed_statement,
+        signed_statement_with_attestation,
+    ):
+        refuse = "export function apply() { return 'Refused by fallback'; }"
+        configure_service(
+            {
+                "policy": {
+                    "policyRoutes": [
+                        {
+                            "issuerPrefix": "did:x509:",
+                            "policyScript": "export function apply() { return 'Refused by x509'; }",
+                        },
+                        {
+                            "issuerPrefix": "did:x509:0:sha256:",
+                            "policyRules": [
+                                {
+                                    "field": "phdr.cwt.iss",
+                                    "op": "startsWith",
+                                    "value": "did:x509:",
+                                }
+                            ],
+                        },
+                    ],
+                    "policyScript": refuse,
+                }
+            }
+        )
+
+        # The longest matching prefix is used
+        client.submit_signed_statement_and_wait(signed_statement())
+
+        # Issuers matching no route use the policy outside of any route
+        with service_error("Policy was not met: Refused by fallback"):
+            client.submit_signed_statement_and_wait(signed_statement_with_attestation)
+
+        configure_service(
+            {
+                "policy": {
+                    "policyRoutes": [
+                        {
+                            "issuerPrefix": "did:x509:",
+                            "policyScript": "export function apply() { return 'Refused by x509'; }",
+                        },
+                    ],
+                    "policyScript": refuse,
+                }
+            }
+        )
+        with service_error("Policy was not met: Refused by x509"):
+            client.submit_signed_statement_and_wait(signed_statement())
@@ -6,7 +6,7 @@ from types import SimpleNamespace
 import pytest
 
 from pyscitt import crypto
-from pyscitt.client import Client
+from pyscitt.client import CBOR_ERR_TITLE_TAG, Client
 from pyscitt.verify import verify_transparent_statement
 
 
@@ -34,6 +34,7 @@ class TestHistorical:
             result.append(
                 SimpleNamespace(
                     signed_statement=signed_statement,
+                    operation_tx=submission.operation_tx,
                     tx=submission.tx,
                     seqno=submission.seqno,
                     receipt=submission.response_bytes,
@@ -52,6 +53,37 @@ class TestHistorical:
         # If we did, we'd have to check for a sub-list instead.
         assert [s.tx for s in submissions] == seqnos
 
+    def test_count_statements(self, client: Client, submissions):
+        count = client.count_statements(
+            start=submissions[0].seqno, end=submissions[-1].seqno
+        )
+        assert count == len(submissions)
+
+        count = client.count_statements(
+            start=submissions[1].seqno, end=submissions[-2].seqno
+        )
+        assert count == len(submissions) - 2
+
+    def test_get_operations(self, client: Client, submissions):
+        operations = client.get_operations(
+            [s.operation_tx for s in submissions] + ["2.1"]
+        )
+        assert len(operations) == len(submissions) + 1
+
+        for submission, operation in zip(submissions, operations):
+            assert operation["OperationId"] == submission.operation_tx
+            assert operation["Status"] == "succeeded"
+            assert operation["EntryId"] == submission.tx
+
+        # Unknown operations are reported individually, without failing the
+        # whole request.
+        assert operations[-1]["OperationId"] == "2.1"
+        assert "Status" not in operations[-1]
+        assert operations[-1]["LookupError"][CBOR_ERR_TITLE_TAG] in (
+            "OperationExpired",
+            "NotFound",
+        )
+
     def test_get_receipt(self, client: Client, trust_store, submissions):
         for s in submissions:
             receipt = client.get_transparent_statement(s.tx)
@@ -46,14 +46,47 @@ export function apply(phdr, uhdr, payload, details) {{
 }}
 """
 
-TEST_POLICY_SCRIPTS = {
-    "x509_hashv": X509_HASHV_POLICY_SCRIPT,
-    "attested_svc": ATTESTEDSVC_POLICY_SCRIPT,
+# Equivalent to ATTESTEDSVC_POLICY_SCRIPT, evaluated natively
+ATTESTEDSVC_POLICY_RULES = [
+    {"field": "details.product_name", "op": "==", "value": "Milan"},
+    {
+        "field": "details.reported_tcb.hexstring",
+        "op": "==",
+        "value": "db18000000000004",
+    },
+    {
+        "field": "details.uvm_endorsements.did",
+        "op": "==",
+        "value": "did:x509:0:sha256:I__iuL25oXEVFdTP_aBLx_eT1RPHbCQ_ECBQfYZpt9s::eku:1.3.6.1.4.1.311.76.59.1.2",
+    },
+    {
+        "field": "details.uvm_endorsements.feed",
+        "op": "==",
+        "value": "ContainerPlat-AMD-UVM",
+    },
+    {"field": "details.uvm_endorsements.svn", "op": ">=", "value": "101"},
+    {
+        "field": "details.host_data",
+        "op": "==",
+        "value": "73973b78d70cc68353426de188db5dfc57e5b766e399935fb73a61127ea26d20",
+    },
+    {
+        "field": "phdr.cwt.iss",
+        "op": "startsWith",
+        "value": "did:attestedsvc:msft-css-dev:",
+    },
+]
+
+TEST_POLICIES = {
+    "x509_hashv": {"policyScript": X509_HASHV_POLICY_SCRIPT},
+    "attested_svc": {"policyScript": ATTESTEDSVC_POLICY_SCRIPT},
+    "attested_svc_rules": {"policyRules": ATTESTEDSVC_POLICY_RULES},
 }
 
 TEST_VECTORS = [
     ("test/payloads/cts-hashv-cwtclaims-b64url.cose", "x509_hashv"),
     ("test/payloads/css-attested-cosesign1-20250925.cose", "attested_svc"),
+    ("test/payloads/css-attested-cosesign1-20250925.cose", "attested_svc_rules"),
 ]
 
 
@@ -71,9 +104,7 @@ def test_statement_latency(
     client: Client, configure_service, signed_statement_path: str, test_name: str
 ):
     client.wait_time = 0.1
-    policy_script = TEST_POLICY_SCRIPTS[test_name]
-
-    configure_service({"policy": {"policyScript": policy_script}})
+    configure_service({"policy": TEST_POLICIES[test_name]})
 
     with open(signed_statement_path, "rb") as f:
         signed_statement = f.read()